@@ -0,0 +1,214 @@
+/**
+ * FrameGate.cpp
+ * Pre-decode quality checks for viewfinder frames.
+**/
+
+#include "FrameGate.h"
+
+#include <cstdlib>
+
+// the grid used for sharpness and exposure has about this many samples across,
+// and is split into TILES_X by TILES_Y tiles for sharpness
+static const int GRID_SAMPLES = 128;
+static const int TILES_X = 8;
+static const int TILES_Y = 6;
+
+FrameGate::Thresholds::Thresholds() :
+minSharpness(150.0),
+minMean(20),
+maxMean(250),
+maxClipped(0.97),
+minFinderCandidates(2),
+rowStep(4)
+{
+}
+
+FrameGate::FrameGate() :
+sharpness(0),
+mean(0),
+darkClipped(0),
+brightClipped(0),
+finderCandidates(0)
+{
+}
+
+FrameGate::FrameGate(const Thresholds &thresholds) :
+thresholds(thresholds),
+sharpness(0),
+mean(0),
+darkClipped(0),
+brightClipped(0),
+finderCandidates(0)
+{
+}
+
+FrameGate::Verdict FrameGate::check(const uchar *luma, int width, int height, int bytesPerLine, int pixelStride)
+{
+	finderCandidates = 0;
+	if (luma == 0 || width < 3 || height < 3) return Pass;
+
+	measureGrid(luma, width, height, bytesPerLine, pixelStride);
+	if (mean < thresholds.minMean || darkClipped > thresholds.maxClipped) return Dark;
+	if (mean > thresholds.maxMean || brightClipped > thresholds.maxClipped) return Bright;
+	if (sharpness < thresholds.minSharpness) return Blurred;
+
+	if (thresholds.minFinderCandidates > 0) {
+		finderCandidates = countFinderCandidates(luma, width, height, bytesPerLine, pixelStride,
+				thresholds.minFinderCandidates);
+		if (finderCandidates < thresholds.minFinderCandidates) return NoFinder;
+	}
+	return Pass;
+}
+
+// Mean and clipping over a sparse grid of samples, and the variance of the 4-neighbour Laplacian
+// of each tile of the grid. A badge usually fills only a few tiles, so sharpness is the variance of
+// the sharpest tile rather than of the whole frame. Each grid row starts one pixel further along so
+// that the samples do not all fall inside the modules of a code whose module size divides the step.
+void FrameGate::measureGrid(const uchar *luma, int width, int height, int bytesPerLine, int pixelStride)
+{
+	const int step = qMax(2, width / GRID_SAMPLES);
+	long long lapSums[TILES_Y][TILES_X] = {{0}}, lapSquares[TILES_Y][TILES_X] = {{0}};
+	int tileSamples[TILES_Y][TILES_X] = {{0}};
+	long long sum = 0;
+	int samples = 0, dark = 0, bright = 0;
+
+	for (int y = 1, gridRow = 0; y < height - 1; y += step, gridRow++) {
+		const uchar *row = luma + y * bytesPerLine;
+		const uchar *up = row - bytesPerLine;
+		const uchar *down = row + bytesPerLine;
+		const int ty = y * TILES_Y / height;
+		for (int x = 1 + gridRow % step; x < width - 1; x += step) {
+			const int i = x * pixelStride;
+			const int c = row[i];
+			const int lap = 4 * c - row[i - pixelStride] - row[i + pixelStride] - up[i] - down[i];
+			const int tx = x * TILES_X / width;
+			lapSums[ty][tx] += lap;
+			lapSquares[ty][tx] += lap * lap;
+			tileSamples[ty][tx]++;
+			sum += c;
+			if (c < 8) dark++;
+			else if (c > 247) bright++;
+			samples++;
+		}
+	}
+
+	sharpness = 0;
+	for (int ty = 0; ty < TILES_Y; ty++) {
+		for (int tx = 0; tx < TILES_X; tx++) {
+			const double n = tileSamples[ty][tx];
+			if (n < 16) continue;
+			const double lapMean = lapSums[ty][tx] / n;
+			sharpness = qMax(sharpness, lapSquares[ty][tx] / n - lapMean * lapMean);
+		}
+	}
+	mean = samples ? int(sum / samples) : 0;
+	darkClipped = samples ? double(dark) / samples : 0;
+	brightClipped = samples ? double(bright) / samples : 0;
+}
+
+// Whether five run lengths are in the 1:1:3:1:1 ratio of a finder pattern, with the tolerance
+// FinderPatternFinder uses. Runs under two pixels a module are too noisy to count.
+static bool finderRatio(const int *runs)
+{
+	const int total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+	if (total < 14) return false;
+	const int module = (total << 8) / 7;
+	const int maxVariance = module / 2;
+	return std::abs(module - (runs[0] << 8)) < maxVariance
+			&& std::abs(module - (runs[1] << 8)) < maxVariance
+			&& std::abs(3 * module - (runs[2] << 8)) < 3 * maxVariance
+			&& std::abs(module - (runs[3] << 8)) < maxVariance
+			&& std::abs(module - (runs[4] << 8)) < maxVariance;
+}
+
+// One pass over rows rowStep apart, thresholded at the frame mean, counting run sequences in the
+// 1:1:3:1:1 ratio whose centre column shows the same ratio vertically. Stops as soon as enough
+// have been seen.
+int FrameGate::countFinderCandidates(const uchar *luma, int width, int height, int bytesPerLine,
+		int pixelStride, int enough) const
+{
+	const int step = qMax(1, thresholds.rowStep);
+	int found = 0;
+
+	for (int y = step / 2; y < height; y += step) {
+		const uchar *row = luma + y * bytesPerLine;
+		// runs[0..4] are the last five runs, the newest at runs[4]
+		int runs[5] = { 0, 0, 0, 0, 0 };
+		bool black = row[0] < mean;
+		int run = 0;
+		for (int x = 0; x <= width; x++) {
+			const bool pixel = x < width && row[x * pixelStride] < mean;
+			if (x < width && pixel == black) {
+				run++;
+				continue;
+			}
+			runs[0] = runs[1]; runs[1] = runs[2]; runs[2] = runs[3]; runs[3] = runs[4];
+			runs[4] = run;
+			// a candidate ends on a black run: black, white, black centre, white, black
+			if (black && finderRatio(runs)) {
+				const int centre = x - runs[4] - runs[3] - runs[2] / 2;
+				if (verticalFinder(luma, height, bytesPerLine, pixelStride, centre, y, runs[2])
+						&& ++found >= enough)
+					return found;
+			}
+			black = pixel;
+			run = 1;
+		}
+	}
+	return found;
+}
+
+// Cross-check of a candidate: the runs above and below (x, y) in the same column, walked out from
+// the black centre, must also be in the finder ratio.
+bool FrameGate::verticalFinder(const uchar *luma, int height, int bytesPerLine, int pixelStride,
+		int x, int y, int centreRun) const
+{
+	const uchar *column = luma + x * pixelStride;
+	// the longest run worth following, the centre run of a clean finder plus slack
+	const int maxRun = 2 * centreRun;
+	int runs[5] = { 0, 0, 1, 0, 0 };
+
+	// up from the centre: rest of the centre, then white, then black
+	int i = y - 1;
+	int state = 2;
+	while (i >= 0 && state >= 0) {
+		const bool black = column[i * bytesPerLine] < mean;
+		const int expected = (state % 2 == 0);
+		if (black != bool(expected)) {
+			if (state == 0) break;
+			state--;
+			continue;
+		}
+		if (++runs[state] > maxRun) return false;
+		i--;
+	}
+	if (runs[0] == 0 || runs[1] == 0) return false;
+
+	// and down
+	i = y + 1;
+	state = 2;
+	while (i < height && state <= 4) {
+		const bool black = column[i * bytesPerLine] < mean;
+		const int expected = (state % 2 == 0);
+		if (black != bool(expected)) {
+			if (state == 4) break;
+			state++;
+			continue;
+		}
+		if (++runs[state] > maxRun) return false;
+		i++;
+	}
+	return runs[3] > 0 && runs[4] > 0 && finderRatio(runs);
+}
+
+const char *FrameGate::verdictName(Verdict v)
+{
+	switch (v) {
+		case Pass: return "pass";
+		case Blurred: return "blurred";
+		case Dark: return "dark";
+		case Bright: return "bright";
+		case NoFinder: return "no finder";
+		default: return "";
+	}
+}
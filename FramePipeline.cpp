@@ -0,0 +1,152 @@
+/**
+ * FramePipeline.cpp
+ * Multi-threaded decoding of camera frames with bounded queueing.
+**/
+
+#include "FramePipeline.h"
+#include "QRScanner.h"
+
+#include <QMutexLocker>
+
+FramePipeline::FramePipeline(int workerCount, int capacity, QObject *parent) :
+QObject(parent),
+capacity(capacity < 1 ? 1 : capacity),
+nextSequence(0),
+stopping(false),
+gating(false),
+gateThresholds(QRScanner::gateThresholds())
+{
+	qRegisterMetaType<quint64>("quint64");
+	counters.pushed = counters.dropped = counters.decoded = counters.found = 0;
+	counters.skipped = counters.blurred = counters.badlyExposed = counters.noFinder = 0;
+	if (workerCount < 1) workerCount = 1;
+	for (int i = 0; i < workerCount; i++) {
+		Worker *w = new Worker(this);
+		workers.append(w);
+		w->start();
+	}
+}
+
+FramePipeline::~FramePipeline()
+{
+	{
+		QMutexLocker lock(&mutex);
+		stopping = true;
+		counters.dropped += ring.size();
+		ring.clear();
+		frameReady.wakeAll();
+	}
+	foreach (Worker *w, workers) {
+		w->wait();
+		delete w;
+	}
+}
+
+void FramePipeline::push(const QVideoFrame &frame)
+{
+	QMutexLocker lock(&mutex);
+	if (stopping) return;
+
+	Frame f;
+	f.sequence = nextSequence++;
+	f.frame = frame;
+	f.gated = false;
+	counters.pushed++;
+
+	// a full ring gives way to the new frame
+	if (ring.size() >= capacity) {
+		ring.removeFirst();
+		counters.dropped++;
+	}
+	ring.append(f);
+	frameReady.wakeOne();
+}
+
+void FramePipeline::flush()
+{
+	QMutexLocker lock(&mutex);
+	counters.dropped += ring.size();
+	ring.clear();
+	while (!pending.empty()) idle.wait(&mutex);
+}
+
+void FramePipeline::setGate(bool enabled, const FrameGate::Thresholds &thresholds)
+{
+	QMutexLocker lock(&mutex);
+	gating = enabled;
+	gateThresholds = thresholds;
+}
+
+FramePipeline::Stats FramePipeline::stats()
+{
+	QMutexLocker lock(&mutex);
+	return counters;
+}
+
+// Blocks until there is a frame to decode. Takes the newest one; anything older still queued
+// would only be decoded after it, so it is dropped instead.
+bool FramePipeline::take(Frame &frame, FrameGate &gate)
+{
+	QMutexLocker lock(&mutex);
+	while (ring.isEmpty() && !stopping) frameReady.wait(&mutex);
+	if (stopping) return false;
+
+	frame = ring.takeLast();
+	counters.dropped += ring.size();
+	ring.clear();
+	frame.gated = gating;
+	gate.setThresholds(gateThresholds);
+
+	Pending p;
+	p.done = false;
+	pending[frame.sequence] = p;
+	return true;
+}
+
+// Records a result and emits every finished frame that no older frame is still holding back.
+void FramePipeline::finish(quint64 sequence, const QString &result, FrameGate::Verdict verdict)
+{
+	QMutexLocker lock(&mutex);
+	Pending &p = pending[sequence];
+	p.done = true;
+	p.result = result;
+	switch (verdict) {
+		case FrameGate::Pass:
+			counters.decoded++;
+			if (!result.isEmpty()) counters.found++;
+			break;
+		case FrameGate::Blurred:
+			counters.skipped++;
+			counters.blurred++;
+			break;
+		case FrameGate::Dark:
+		case FrameGate::Bright:
+			counters.skipped++;
+			counters.badlyExposed++;
+			break;
+		default:
+			counters.skipped++;
+			counters.noFinder++;
+			break;
+	}
+
+	while (!pending.empty() && pending.begin()->second.done) {
+		emit frameDecoded(pending.begin()->first, pending.begin()->second.result);
+		pending.erase(pending.begin());
+	}
+	if (pending.empty()) idle.wakeAll();
+}
+
+void FramePipeline::Worker::run()
+{
+	QRScanner scan;
+	FrameGate gate;
+	Frame f;
+	while (owner->take(f, gate)) {
+		FrameGate::Verdict verdict = FrameGate::Pass;
+		QString result = scan.decodeFrame(f.frame, f.sequence, f.gated ? &gate : 0, &verdict);
+		// let go of the frame before reporting, so its buffer can go back to the camera
+		f.frame = QVideoFrame();
+		owner->finish(f.sequence, result, verdict);
+	}
+}
@@ -9,6 +9,7 @@
 #include "videosettings.h"
 #include "imagesettings.h"
 #include "database/user.h"
+#include "database/recentscans.h"
 #include <iostream>
 
 #include <QMediaService>
@@ -16,6 +17,9 @@
 #include <QCameraViewfinder>
 #include <QCameraInfo>
 #include <QMediaMetaData>
+#include <QTimer>
+#include <QThread>
+#include <QLabel>
 
 #include <QMessageBox>
 #include <QPalette>
@@ -34,12 +38,44 @@ ui(new Ui::Camera),
 camera(0),
 imageCapture(0),
 mediaRecorder(0),
+probe(0),
+scanning(false),
+scanInterval(1000 / 8),
+pipeline(0),
+statsTimer(0),
+statsLabel(0),
+framesSeen(0),
+checkins(0),
 isCapturingImage(false),
 applicationExiting(false)
 {
     ui->setupUi(this);
     current = currentActivity;
     win = myWin;
+
+	// continuous scanning reports its frame and decode rates once a second
+	statsLabel = new QLabel(this);
+	ui->statusbar->addPermanentWidget(statsLabel);
+	statsTimer = new QTimer(this);
+	statsTimer->setInterval(1000);
+	connect(statsTimer, SIGNAL(timeout()), this, SLOT(updateScanStats()));
+	if (qEnvironmentVariableIsSet("BOO_SCAN_FPS"))
+		setScanRate(qgetenv("BOO_SCAN_FPS").toInt());
+
+	// decoding runs off the UI thread, on one worker per core up to four unless BOO_SCAN_WORKERS
+	// says otherwise; each worker has its own reader and zxing's shared tables are read-only
+	int workers = qgetenv("BOO_SCAN_WORKERS").toInt();
+	if (workers < 1) workers = qBound(1, QThread::idealThreadCount(), 4);
+	pipeline = new FramePipeline(workers, workers + 1);
+	connect(pipeline, SIGNAL(frameDecoded(quint64,QString)), this, SLOT(handleFrameDecoded(quint64,QString)));
+
+	// blurred, badly exposed and badge-less frames are skipped before decoding; BOO_SCAN_GATE=0
+	// turns that off and BOO_SCAN_SHARPNESS moves the blur threshold
+	FrameGate::Thresholds gate = QRScanner::gateThresholds();
+	if (qEnvironmentVariableIsSet("BOO_SCAN_SHARPNESS"))
+		gate.minSharpness = qgetenv("BOO_SCAN_SHARPNESS").toDouble();
+	pipeline->setGate(qgetenv("BOO_SCAN_GATE") != "0", gate);
+	lastStats = scanStart = pipeline->stats();
 	//Camera devices:
 
 	QActionGroup *videoDevicesGroup = new QActionGroup(this);
@@ -60,13 +96,22 @@ applicationExiting(false)
 
 Camera::~Camera()
 {
+	delete pipeline;
+	delete probe;
 	delete mediaRecorder;
 	delete imageCapture;
 	delete camera;
 }
 
+void Camera::setScanRate(int framesPerSecond)
+{
+	if (framesPerSecond > 0)
+		scanInterval = 1000 / framesPerSecond;
+}
+
 void Camera::setCamera(const QCameraInfo &cameraInfo)
 {
+	delete probe;
 	delete imageCapture;
 	delete mediaRecorder;
 	delete camera;
@@ -87,6 +132,13 @@ void Camera::setCamera(const QCameraInfo &cameraInfo)
 
 	camera->setViewfinder(ui->viewfinder);
 
+	// viewfinder frames for continuous scanning; not every backend can probe a camera
+	probe = new QVideoProbe(this);
+	connect(probe, SIGNAL(videoFrameProbed(QVideoFrame)), this, SLOT(processFrame(QVideoFrame)));
+	bool canProbe = probe->setSource(camera);
+	if (!canProbe) ui->continuousButton->setChecked(false);
+	ui->continuousButton->setEnabled(canProbe);
+
 	updateCameraState(camera->state());
 	updateLockStatus(camera->lockStatus(), QCamera::UserRequest);
 	updateRecorderState(mediaRecorder->state());
@@ -163,17 +215,114 @@ void Camera::processCapturedImage(int requestId, const QImage& img)
 	if (result==QString("")) {
 		QMessageBox::warning(this, tr("Error"), QString("No QR symbols found."));
 	}
-    else {
-        // do SOMETHING with the data...
-        User* theUser = User::getUserWithUUID(result.toUtf8().data());
-        std::cout << theUser->getUUID() << std::endl;
-        Checkin *c = Checkin::createCheckin(theUser->getUserId(), current->getId());
-        current->addCheckins(c);
-        win->updateList();
+    else if (checkInBadge(result, true)) {
         this->close();
     }
 }
 
+// Checks the badge in to the current activity; true only when a new check-in was stored. Interactive
+// (still capture) failures pop up a warning and let the badge be retried at once; in continuous mode
+// they only go to the status bar, and the badge stays in RecentScans so a bad badge is not looked up
+// again on every frame. A badge that is already checked in is reported as such and not counted again.
+bool Camera::checkInBadge(const QString &result, bool interactive)
+{
+    std::string uuid = result.toUtf8().data();
+    // the same badge held in front of the camera is rejected here, before touching the database
+    if (!RecentScans::accept(uuid, current->getId())) {
+        if (interactive) ui->statusbar->showMessage(tr("Badge already scanned"), 3000);
+        return false;
+    }
+    User* theUser = User::getUserWithUUID(uuid);
+    // a badge nobody in the database wears comes back as a user with id 0
+    size_t userid = theUser->getUserId();
+    delete theUser;
+    bool existed = false;
+    Checkin *c = userid != 0 ? Checkin::createCheckin(userid, current->getId(), &existed) : 0;
+    if (!c) {
+        QString message = userid != 0 ? tr("Check-in failed for this badge.") : tr("Unknown badge.");
+        if (interactive) {
+            RecentScans::forget(uuid, current->getId());
+            QMessageBox::warning(this, tr("Error"), message);
+        } else {
+            ui->statusbar->showMessage(message, 3000);
+        }
+        return false;
+    }
+    // checked in by an earlier scan, possibly before the window was opened: nothing new to list or count
+    if (existed) {
+        delete c;
+        if (interactive) {
+            QMessageBox::information(this, tr("Check-in"), tr("Already checked in."));
+        } else {
+            ui->statusbar->showMessage(tr("Already checked in"), 3000);
+        }
+        return false;
+    }
+    current->addCheckins(c);
+    win->updateList();
+    return true;
+}
+
+void Camera::on_continuousButton_toggled(bool checked)
+{
+	scanning = checked;
+	if (!checked) pipeline->flush();
+	framesSeen = checkins = 0;
+	lastStats = scanStart = pipeline->stats();
+	sinceLastDecode.invalidate();
+	ui->takeImageButton->setVisible(!checked);
+	if (checked) {
+		displayViewfinder();
+		statsClock.start();
+		statsTimer->start();
+		statsLabel->setText(tr("Scanning..."));
+	} else {
+		statsTimer->stop();
+		statsLabel->clear();
+	}
+}
+
+// Called for every viewfinder frame. Frames arriving before the next decode is due are only counted,
+// which keeps decoding at the configured rate whatever the camera delivers.
+void Camera::processFrame(const QVideoFrame &frame)
+{
+	if (!scanning) return;
+	framesSeen++;
+	if (sinceLastDecode.isValid() && sinceLastDecode.elapsed() < scanInterval) return;
+	sinceLastDecode.start();
+	pipeline->push(frame);
+}
+
+void Camera::handleFrameDecoded(quint64 sequence, const QString &result)
+{
+	Q_UNUSED(sequence);
+	if (!scanning) return;
+	if (result.isEmpty()) return;
+	if (checkInBadge(result, false)) {
+		checkins++;
+		ui->statusbar->showMessage(tr("Checked in"), 2000);
+	}
+}
+
+void Camera::updateScanStats()
+{
+	double seconds = statsClock.restart() / 1000.0;
+	if (seconds <= 0) return;
+	FramePipeline::Stats stats = pipeline->stats();
+	statsLabel->setText(tr("%1 fps, %2 decodes/s, %3 skipped/s, %4 dropped/s, %5 check-ins")
+			.arg(framesSeen / seconds, 0, 'f', 1)
+			.arg((stats.decoded - lastStats.decoded) / seconds, 0, 'f', 1)
+			.arg((stats.skipped - lastStats.skipped) / seconds, 0, 'f', 1)
+			.arg((stats.dropped - lastStats.dropped) / seconds, 0, 'f', 1)
+			.arg(checkins));
+	statsLabel->setToolTip(tr("Skipped since scanning started: %1 blurred, %2 badly exposed, %3 without a badge")
+			.arg(stats.blurred - scanStart.blurred)
+			.arg(stats.badlyExposed - scanStart.badlyExposed)
+			.arg(stats.noFinder - scanStart.noFinder));
+	framesSeen = 0;
+	lastStats = stats;
+}
+
 void Camera::configureCaptureSettings()
 {
 	switch (camera->captureMode()) {
@@ -363,6 +512,7 @@ void Camera::closeEvent(QCloseEvent *event)
 		applicationExiting = true;
 	event->ignore();
 	} else {
+		ui->continuousButton->setChecked(false);
 		event->accept();
 	}
 }
@@ -15,8 +15,8 @@ using namespace std;
 using namespace qrcodegen;
 
 QPainter* QRHandler::generate(QPainter* painter, QSize sz, QString data, QColor fg, QColor bg) {
-	char *str=data.toUtf8().data();
-	QrCode qr = QrCode::encodeText(str, QrCode::Ecc::HIGH);
+	QByteArray utf8=data.toUtf8();
+	QrCode qr = QrCode::encodeText(utf8.constData(), QrCode::Ecc::HIGH);
 	const int s=qr.size>0?qr.size:1;
 	const double w=sz.width();
 	const double h=sz.height();
@@ -24,13 +24,7 @@ QPainter* QRHandler::generate(QPainter* painter, QSize sz, QString data, QColor
 	const double size=((aspect>1.0)?h:w);
 	const double scale=size/(s+2);
 	painter->setPen(Qt::NoPen);
-	painter->setBrush(bg);
-	for(int y=0; y<400; y++) {
-		for(int x=0; x<400; x++) {
-			QRectF r(x, y, 1, 1);
-			painter->drawRects(&r,1);
-		}
-	}
+	painter->fillRect(QRectF(0, 0, w, h), bg);
 	painter->setBrush(fg);
 	for(int y=0; y<s; y++) {
 		for(int x=0; x<s; x++) {
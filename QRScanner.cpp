@@ -6,16 +6,129 @@
 #include <QZXing.h>
 #include <QString>
 #include <QImage>
+#include <QVideoFrame>
+#include <QThreadStorage>
 
 #include "QRScanner.h"
 
+// One decoder per thread, created on first use and kept for the life of the thread,
+// so a decode no longer pays for building a QZXing and its readers.
+static QThreadStorage<QZXing*> decoders;
+
+// formats every decoder() reads
+static const uint FORMATS = QZXing::DecoderFormat_QR_CODE | QZXing::DecoderFormat_EAN_13;
+
+QZXing* QRScanner::decoder() {
+	if (!decoders.hasLocalData()) {
+		QZXing* zx = new QZXing();
+		zx->setDecoder(FORMATS);
+		// badges are often held in uneven light, so the block-wise binarizer gets a say unless
+		// BOO_SCAN_BINARIZER pins one down
+		QByteArray binarizer = qgetenv("BOO_SCAN_BINARIZER");
+		if (binarizer == "global")
+			zx->setBinarizer(QZXing::Binarizer_Global);
+		else if (binarizer == "hybrid")
+			zx->setBinarizer(QZXing::Binarizer_Hybrid);
+		else
+			zx->setBinarizer(QZXing::Binarizer_Auto);
+		decoders.setLocalData(zx);
+	}
+	return decoders.localData();
+}
+
+// The gate's finder check looks for QR finder patterns only, so it is turned off while any other
+// format is enabled: a frame holding just a 1D barcode has none and would never be decoded.
+FrameGate::Thresholds QRScanner::gateThresholds() {
+	FrameGate::Thresholds t;
+	if (FORMATS != QZXing::DecoderFormat_QR_CODE) t.minFinderCandidates = 0;
+	return t;
+}
+
 QString QRScanner::decode(QImage img) {
-	QZXing decoder;
-	decoder.setDecoder( QZXing::DecoderFormat_QR_CODE | QZXing::DecoderFormat_EAN_13 );
-	return decoder.decodeImage(img);
+	return decoder()->decodeImage(img);
 }
 
 QString QRScanner::decodeFromFile(QString path) {
 	if (path.isEmpty()) return "ERROR";
 	return decode(QImage(path));
 }
+
+// Where the gate finds luminance in a mapped frame: the Y plane of planar YUV, or the green
+// bytes of packed RGB. Returns false for formats the gate does not read.
+static bool lumaOf(const QVideoFrame &frame, const uchar *&luma, int &pixelStride) {
+	switch (frame.pixelFormat()) {
+		case QVideoFrame::Format_YUV420P:
+		case QVideoFrame::Format_YV12:
+		case QVideoFrame::Format_NV12:
+		case QVideoFrame::Format_NV21:
+		case QVideoFrame::Format_Y8:
+			luma = frame.bits();
+			pixelStride = 1;
+			return true;
+		case QVideoFrame::Format_ARGB32:
+		case QVideoFrame::Format_ARGB32_Premultiplied:
+		case QVideoFrame::Format_RGB32:
+			// green is bits 8-15 of each pixel
+			luma = frame.bits() + (Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 1 : 2);
+			pixelStride = 4;
+			return true;
+		case QVideoFrame::Format_BGRA32:
+		case QVideoFrame::Format_BGRA32_Premultiplied:
+		case QVideoFrame::Format_BGR32:
+			// green is bits 16-23 of each pixel
+			luma = frame.bits() + (Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 2 : 1);
+			pixelStride = 4;
+			return true;
+		case QVideoFrame::Format_RGB24:
+		case QVideoFrame::Format_BGR24:
+			luma = frame.bits() + 1;
+			pixelStride = 3;
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Decodes a viewfinder frame in place: planar YUV frames hand their Y plane straight to
+// the decoder, RGB frames are wrapped in a QImage over the mapped bytes.
+QString QRScanner::decodeFrame(QVideoFrame frame, quint64 sequence, FrameGate *gate, FrameGate::Verdict *verdict) {
+	if (verdict) *verdict = FrameGate::Pass;
+	if (!frame.map(QAbstractVideoBuffer::ReadOnly)) return "";
+
+	const uchar *luma;
+	int pixelStride;
+	if (gate && lumaOf(frame, luma, pixelStride)) {
+		FrameGate::Verdict v = gate->check(luma, frame.width(), frame.height(), frame.bytesPerLine(), pixelStride);
+		if (verdict) *verdict = v;
+		if (v != FrameGate::Pass) {
+			frame.unmap();
+			return "";
+		}
+	}
+
+	// recent frames show the badge in about the same place, so look there first; with several
+	// workers this thread's decoder sees only some of the frames, and the sequence tells it which
+	decoder()->setTracking(true);
+	decoder()->setFrameNumber(sequence);
+
+	QString result;
+	switch (frame.pixelFormat()) {
+		case QVideoFrame::Format_YUV420P:
+		case QVideoFrame::Format_YV12:
+		case QVideoFrame::Format_NV12:
+		case QVideoFrame::Format_NV21:
+		case QVideoFrame::Format_Y8:
+			result = decoder()->decodeGrayscale(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine());
+			break;
+		default: {
+			QImage::Format format = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+			if (format != QImage::Format_Invalid) {
+				QImage img(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine(), format);
+				result = decoder()->decodeImage(img, img.width(), img.height());
+			}
+		}
+	}
+
+	frame.unmap();
+	return result;
+}
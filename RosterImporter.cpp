@@ -0,0 +1,213 @@
+/**
+ * RosterImporter.cpp
+ * Bulk import of attendees from a CSV roster.
+ *
+ * Rows are streamed from the file and inserted in batched transactions; each batch also
+ * records how many rows are committed, so a failed or interrupted import resumes where it
+ * stopped. Badges are rendered on the importer's own thread pool while the next batch is inserted.
+ * run() blocks until the import is done, so a window starts it on another thread.
+ *
+ * Expected columns: first name, last name, username. A header row naming exactly these
+ * columns (first/firstname, last/lastname, username) is skipped.
+**/
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrent>
+
+#include "RosterImporter.h"
+#include "QRHandler.h"
+#include "database/database.h"
+#include "database/rosterimport.h"
+#include "database/user.h"
+
+using namespace std;
+
+// number of badges rendered by one pool task
+static const int BADGES_PER_TASK = 64;
+
+static void renderBadges(QStringList uuids, QString dir, QAtomicInt* counter) {
+	QRHandler handler;
+	foreach (const QString& uuid, uuids) {
+		if (handler.generateToFile(uuid, dir + "/" + uuid + ".png")) counter->ref();
+	}
+}
+
+// a header row names the three columns exactly; a data row for someone named "First" is not one
+static bool isHeaderRow(const QStringList& fields) {
+	if (fields.size() < 3) return false;
+	for (int i = 3; i < fields.size(); i++) {
+		if (!fields[i].trimmed().isEmpty()) return false;
+	}
+	QString first = fields[0].trimmed().toLower();
+	QString last = fields[1].trimmed().toLower();
+	QString username = fields[2].trimmed().toLower();
+	return (first == "first" || first == "firstname" || first == "first name") &&
+		(last == "last" || last == "lastname" || last == "last name") &&
+		username == "username";
+}
+
+RosterImporter::RosterImporter(QString csvPath, size_t _eventid, QString _badgeDir, QObject* parent) :
+QObject(parent),
+path(csvPath),
+eventid(_eventid),
+badgeDir(_badgeDir),
+batchSize(1000),
+rows(0),
+badges(0)
+{
+}
+
+RosterImporter::~RosterImporter() {
+	pool.waitForDone();
+}
+
+void RosterImporter::setBatchSize(int size) {
+	batchSize = size > 0 ? size : 1;
+}
+
+int RosterImporter::rowsImported() const {
+	return rows;
+}
+
+int RosterImporter::badgesWritten() const {
+	return badges.load();
+}
+
+QString RosterImporter::errorString() const {
+	return error;
+}
+
+bool RosterImporter::run() {
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		error = tr("Cannot open %1").arg(path);
+		return false;
+	}
+	if (!QDir().mkpath(badgeDir)) {
+		error = tr("Cannot create badge directory %1").arg(badgeDir);
+		return false;
+	}
+
+	string key = QFileInfo(path).absoluteFilePath().toStdString();
+	size_t committed = RosterImport::loadProgress(key, eventid);
+	rows = (int)committed;
+
+	// resuming: badges of already committed rows may not have been written yet
+	if (committed > 0) {
+		vector<string> missing;
+		vector<string> uuids = User::getUUIDsByEventId(eventid);
+		for (size_t i = 0; i < uuids.size(); i++) {
+			if (!QFile::exists(badgeDir + "/" + QString::fromStdString(uuids[i]) + ".png")) missing.push_back(uuids[i]);
+		}
+		queueBadges(missing);
+	}
+
+	QTextStream in(&file);
+	in.setCodec("UTF-8");
+	const qint64 total = qMax<qint64>(file.size(), 1);
+	size_t dataRow = 0;
+	bool firstLine = true;
+	vector<UserInfo> batch;
+	batch.reserve(batchSize);
+
+	while (true) {
+		QString line;
+		bool atEnd = in.atEnd();
+		if (!atEnd) line = in.readLine();
+
+		if (!atEnd && !line.trimmed().isEmpty()) {
+			QStringList fields = parseCsvLine(line);
+			if (firstLine) {
+				firstLine = false;
+				if (isHeaderRow(fields)) continue;
+			}
+			if (dataRow++ < committed) continue;
+
+			UserInfo u;
+			u.fname = fields.value(0).trimmed().toStdString();
+			u.lname = fields.value(1).trimmed().toStdString();
+			u.username = fields.value(2).trimmed().toStdString();
+			batch.push_back(u);
+		}
+
+		if (batch.size() >= (size_t)batchSize || (atEnd && !batch.empty())) {
+			if (!Database::beginTransaction()) {
+				error = tr("Cannot start a transaction");
+				waitForBadges(0);
+				return false;
+			}
+			vector<string> uuids = User::createUsers(batch, eventid);
+			if (uuids.size() != batch.size() ||
+				!RosterImport::saveProgress(key, eventid, committed + batch.size()) ||
+				!Database::commitTransaction()) {
+				Database::rollbackTransaction();
+				error = tr("Import stopped after %1 rows; run it again to resume").arg(rows);
+				waitForBadges(0);
+				return false;
+			}
+			committed += batch.size();
+			rows = (int)committed;
+			batch.clear();
+			queueBadges(uuids);
+			emit progress((int)(file.pos() * 100 / total), rows, badges.load());
+		}
+
+		if (atEnd) break;
+	}
+
+	waitForBadges(100);
+	RosterImport::clearProgress(key, eventid);
+	emit progress(100, rows, badges.load());
+	return true;
+}
+
+void RosterImporter::queueBadges(const vector<string>& uuids) {
+	for (size_t i = 0; i < uuids.size(); i += BADGES_PER_TASK) {
+		QStringList chunk;
+		for (size_t j = i; j < uuids.size() && j < i + BADGES_PER_TASK; j++) {
+			chunk << QString::fromStdString(uuids[j]);
+		}
+		QtConcurrent::run(&pool, renderBadges, chunk, badgeDir, &badges);
+	}
+}
+
+// blocks on the pool, waking every so often only to report the badges written so far
+void RosterImporter::waitForBadges(int percent) {
+	while (!pool.waitForDone(250)) {
+		emit progress(percent, rows, badges.load());
+	}
+}
+
+// splits one CSV record; handles quoted fields and "" escapes, not line breaks inside quotes
+QStringList RosterImporter::parseCsvLine(const QString& line) {
+	QStringList fields;
+	QString field;
+	bool quoted = false;
+	for (int i = 0; i < line.size(); i++) {
+		QChar c = line[i];
+		if (quoted) {
+			if (c == '"') {
+				if (i + 1 < line.size() && line[i + 1] == '"') {
+					field += '"';
+					i++;
+				} else {
+					quoted = false;
+				}
+			} else {
+				field += c;
+			}
+		} else if (c == '"') {
+			quoted = true;
+		} else if (c == ',') {
+			fields << field;
+			field.clear();
+		} else {
+			field += c;
+		}
+	}
+	fields << field;
+	return fields;
+}
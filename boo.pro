@@ -1,7 +1,7 @@
 CONFIG += c++11
 CONFIG -= app_bundle
 include(scan/QZXing.pri)
-QT       += core gui multimedia widgets multimediawidgets
+QT       += core gui multimedia widgets multimediawidgets concurrent
 INCLUDEPATH += ./include/
 INCLUDEPATH += ./include/gen/
 TEMPLATE = app
@@ -26,16 +26,21 @@ SOURCES += main.cpp \
     database/database.cpp \
     database/event.cpp \
     database/user.cpp \
+    database/rosterimport.cpp \
+    database/recentscans.cpp \
     database/sqlite3.c \
     gui/prereqselectwindow.cpp \
     database/guid.cpp \
     database/dbtest.cpp \
     ./QRHandler.cpp \
     QRScanner.cpp \
+    FramePipeline.cpp \
+    FrameGate.cpp \
     gen/BitBuffer.cpp \
     gen/QrCodeGen.cpp \
     gen/QrSegment.cpp \
     QRCapture.cpp \
+    RosterImporter.cpp \
     imagesettings.cpp \
     videosettings.cpp
 
@@ -61,17 +66,22 @@ HEADERS  += gui/mainwindow.h \
     database/database.h \
     database/event.h \
     database/user.h \
+    database/rosterimport.h \
+    database/recentscans.h \
     database/sqlite3.h \
     database/dbtest.h \
     gui/prereqselectwindow.h \
     include/QRHandler.h \
     include/QRScanner.h \
+    include/FramePipeline.h \
+    include/FrameGate.h \
     include/gen/BitBuffer.hpp \
     include/gen/QrCodeGen.hpp \
     include/gen/QrSegment.hpp \
     include/imagesettings.h \
     include/videosettings.h \
-    include/QRCapture.h
+    include/QRCapture.h \
+    include/RosterImporter.h
 
 FORMS    += gui/mainwindow.ui \
     gui/eventcreatewindow.ui \
@@ -94,6 +104,14 @@ FORMS    += gui/mainwindow.ui \
 
 DISTFILES += README.txt
 
+# qmake CONFIG+=bench builds test.cpp, with the scanner benchmarks, instead of the application
+bench {
+    SOURCES -= main.cpp
+    SOURCES += test.cpp
+    TARGET = boo-bench
+    CONFIG += console
+}
+
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
 # depend on your compiler). Please consult the documentation of the
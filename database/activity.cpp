@@ -18,7 +18,11 @@ Activity::Activity(size_t _id, string act_name, size_t event_id, string _status)
 
  Activity* Activity::createActivity(string activity_name, size_t event_id, string activity_status) {
     int retval;
-    sqlite3* db = Database::openDatabase();
+    sqlite3* db = Database::openEventDatabase(event_id);
+    if (db == NULL) {
+        cout << "Cannot open event " << event_id << " for creating an activity" << endl;
+        return NULL;
+    }
     sqlite3_stmt *s;
     const char *sql = "INSERT INTO activities (name, eventid, status) VALUES (?, (select eventid from events where eventid = ?), ?)";
     retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
@@ -15,8 +15,15 @@ Checkin::Checkin(size_t _id, size_t user_id, size_t act_id)
     userID = user_id;
 }
 
-Checkin* Checkin::createCheckin(size_t user_id, size_t act_id)
+/**
+  * Checks the user in to the activity. A user already checked in gets the existing row back instead of a
+  * second one; *existed (when given) says which of the two happened.
+  */
+Checkin* Checkin::createCheckin(size_t user_id, size_t act_id, bool* existed)
 {
+    if (existed) {
+        *existed = false;
+    }
     sqlite3* db = Database::openDatabase();
     int retval;
     sqlite3_stmt* s;
@@ -56,6 +63,33 @@ Checkin* Checkin::createCheckin(size_t user_id, size_t act_id)
     }
     sqlite3_reset(s);
 
+    // A badge scanned twice must not produce a second row for the same user and activity
+    sql = "SELECT checkinid FROM checkins WHERE userid = ? and activityid = ?";
+    retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
+    if (retval != SQLITE_OK) {
+        cout << "Error in preparing select statement for checkins: error code " << sqlite3_errcode(db) << endl;
+        return NULL;
+    }
+    retval = sqlite3_bind_int(s, 1, user_id);
+    if (retval != SQLITE_OK) {
+        cout << "Error binding userid int to SQL statement " << sql << endl;
+        return NULL;
+    }
+    retval = sqlite3_bind_int(s, 2, act_id);
+    if (retval != SQLITE_OK) {
+        cout << "Error binding activityid int to SQL statement " << sql << endl;
+        return NULL;
+    }
+    if (sqlite3_step(s) == SQLITE_ROW) {
+        size_t existing_id = (size_t)sqlite3_column_int(s, 0);
+        sqlite3_finalize(s);
+        if (existed) {
+            *existed = true;
+        }
+        return new Checkin(existing_id, user_id, act_id);
+    }
+    sqlite3_finalize(s);
+
     sql = "INSERT INTO checkins(userid, activityid) values (?, ?)";
     retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
     if (retval != SQLITE_OK) {
@@ -10,7 +10,7 @@ class Activity;
 
 class Checkin {
     public:
-        static Checkin* createCheckin(size_t, size_t);
+        static Checkin* createCheckin(size_t, size_t, bool* existed = NULL);
         static Checkin* loadCheckinById(size_t);
         std::string getUUID();
         size_t getUserId();
@@ -4,60 +4,138 @@
 #include <cstdlib>
 #include "database/event.h"
 #include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 using namespace std;
 /** 
   * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
-  * Singleton Database class that opens a .db file through a static method, creates 5 tables inside of the file.
+  * Singleton Database class that opens a .db file through a static method, creates 6 tables inside of the file.
   *
   * @author Hayden Estey
   */
 
 Database* Database::instance = 0;
+Database::StorageMode Database::mode = Database::SINGLE_FILE;
+size_t Database::currentEvent = 0;
+set<size_t> Database::attached;
 
-Database::Database() {
-    int retval;
-    retval = sqlite3_open("boo.db", &db);
-    if (retval != 0) {
-        cout << "Cannot open boo.db: " << sqlite3_errcode(db) << endl;
-        exit(1);
+int Database::cacheKiB = 0;
+long long Database::mmapBytes = -1;
+double Database::openMillis = 0;
+bool Database::schemaCreated = false;
+void (*Database::eventSwitched)(size_t) = 0;
+
+static const char* CATALOG_FILE = "boo_catalog.db";
+
+// files SQLite may keep next to a database, which belong with it wherever it goes
+static const char* SIDECARS[] = { "", "-journal", "-wal", "-shm" };
+static const int SIDECAR_COUNT = sizeof(SIDECARS) / sizeof(SIDECARS[0]);
+
+static bool fileExists(const string& file) {
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f) {
+        return false;
     }
-    
-    //Creating tables
+    fclose(f);
+    return true;
+}
 
-    char* errmsg;
-    retval = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS events (eventid integer primary key, event_name text, description text, org_name text, event_status text);", NULL, NULL, &errmsg);
-    if (retval != SQLITE_OK) {
-        cout << "Error creating event table: " << errmsg << endl;
-        sqlite3_free(errmsg);
+static bool makeDirectory(const string& dir) {
+#ifdef _WIN32
+    int retval = _mkdir(dir.c_str());
+#else
+    int retval = mkdir(dir.c_str(), 0777);
+#endif
+    return retval == 0 || errno == EEXIST;
+}
+
+// Moves a database file and its sidecars; on failure moves back the ones already moved.
+static bool moveDatabaseFiles(const string& from, const string& to) {
+    int moved = 0;
+    for (; moved < SIDECAR_COUNT; moved++) {
+        string source = from + SIDECARS[moved];
+        if (moved > 0 && !fileExists(source)) {
+            continue;
+        }
+        if (rename(source.c_str(), (to + SIDECARS[moved]).c_str()) != 0) {
+            cout << "Cannot move " << source << " to " << to + SIDECARS[moved] << endl;
+            break;
+        }
     }
-    
-    retval = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS users (userid integer primary key, uuid text, username text, fname text, lname text, eventid int, FOREIGN KEY(eventid) REFERENCES events(eventid));", NULL, NULL, &errmsg);
-    if (retval != SQLITE_OK) {
-        cout << "Error creating users table: " << errmsg << endl;
-        sqlite3_free(errmsg);
+    if (moved == SIDECAR_COUNT) {
+        return true;
+    }
+    while (moved-- > 0) {
+        rename((to + SIDECARS[moved]).c_str(), (from + SIDECARS[moved]).c_str());
     }
+    return false;
+}
 
-    retval = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS activities (activityid integer primary key, name text, eventid int, status text, FOREIGN KEY (eventid) REFERENCES events(eventid));", NULL, NULL, &errmsg);
+// Bump whenever the DDL below changes; files stamped with an older (or no) version run the DDL again on open.
+static const int SCHEMA_VERSION = 1;
+
+static bool execOrLog(sqlite3* db, const char* sql, const char* what) {
+    char* errmsg;
+    int retval = sqlite3_exec(db, sql, NULL, NULL, &errmsg);
     if (retval != SQLITE_OK) {
-        cout << "Error creating activites table: " << errmsg << endl;
+        cout << "Error " << what << ": " << errmsg << endl;
         sqlite3_free(errmsg);
+        return false;
     }
+    return true;
+}
 
-    retval = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS prerequisites (activityid integer, prereqid integer, FOREIGN KEY(activityid) REFERENCES activities(activityid), FOREIGN KEY(prereqid) REFERENCES activities(activityid));", NULL, NULL, &errmsg);
-    if (retval != SQLITE_OK) {
-        cout << "Error creating prereq table: " << errmsg << endl;
-        sqlite3_free(errmsg);
+// A statement left stepping by a model class keeps its read transaction (and file lock) open,
+// which blocks DETACH and, once the connection is closed, writes to the catalog from the next one.
+static void releaseStatements(sqlite3* db) {
+    sqlite3_stmt* s = NULL;
+    while ((s = sqlite3_next_stmt(db, s)) != NULL) {
+        if (sqlite3_stmt_busy(s)) {
+            sqlite3_reset(s);
+        }
     }
+}
 
-    retval = sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS checkins (checkinid integer PRIMARY KEY, userid int, activityid int, FOREIGN KEY(userid) REFERENCES users(userid), FOREIGN KEY(activityid) REFERENCES activities(activityid));", NULL, NULL, &errmsg);
-    if (retval != SQLITE_OK) {
-        cout << "Error creating checkins table: " << errmsg << endl;
-        sqlite3_free(errmsg);
+// Reads the version stamped by setSchemaVersion() with a single PRAGMA; 0 for a new or pre-versioning file.
+static int schemaVersion(sqlite3* db) {
+    sqlite3_stmt* s;
+    int version = 0;
+    if (sqlite3_prepare(db, "PRAGMA user_version", -1, &s, NULL) == SQLITE_OK) {
+        if (sqlite3_step(s) == SQLITE_ROW) {
+            version = sqlite3_column_int(s, 0);
+        }
+        sqlite3_finalize(s);
+    }
+    return version;
+}
+
+static bool setSchemaVersion(sqlite3* db) {
+    stringstream sql;
+    sql << "PRAGMA user_version = " << SCHEMA_VERSION << ";";
+    return execOrLog(db, sql.str().c_str(), "stamping schema version");
+}
+
+// Stamps and commits the schema transaction if every DDL statement in it succeeded. Otherwise rolls it back
+// and leaves the old version, so the next open tries again instead of taking a half-built schema as current.
+static void finishSchema(sqlite3* db, bool ok) {
+    if (ok && setSchemaVersion(db) && execOrLog(db, "COMMIT;", "committing schema")) {
+        return;
     }
+    cout << "Schema update failed; it will be retried on the next open." << endl;
+    sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+}
 
-    //Make a default event if it does not exist
-    
+//Make a default event if it does not exist
+static void createDefaultEvent(sqlite3* db) {
+    int retval;
     sqlite3_stmt* s;
     const char* sql = "SELECT eventid FROM events";
     retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
@@ -65,9 +143,10 @@ Database::Database() {
         cout << "Error preparing SQL statement " << sql << " (to create default event): error code " << sqlite3_errcode(db) << endl;
         return;
     }
-    if (sqlite3_step(s) == SQLITE_DONE) {
+    int found = sqlite3_step(s);
+    sqlite3_finalize(s);
+    if (found == SQLITE_DONE) {
         cout << "Creating a default event." << endl;
-        sqlite3_reset(s);
         sql = "INSERT INTO events (event_name, description, org_name, event_status) values (\"Naked Mole Rat Exhibition\", \"An exhibition on Naked Mole Rats\", \"The Joshua Eckroth Foundation\", \"Upcoming\")";
         retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
         if (retval != SQLITE_OK) {
@@ -76,13 +155,130 @@ Database::Database() {
         }
         if (sqlite3_step(s) != SQLITE_DONE) {
             cout << "Error executing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
-            return;
         }
-    } else {
-        sqlite3_reset(s);
+        sqlite3_finalize(s);
     }
 }
 
+Database::Database() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    schemaCreated = false;
+    if (mode == PER_EVENT) {
+        if (!openCatalog()) {
+            exit(1);
+        }
+        applyPragmas();
+        if (schemaVersion(db) != SCHEMA_VERSION) {
+            schemaCreated = true;
+            bool ok = execOrLog(db, "BEGIN TRANSACTION;", "beginning schema transaction");
+            ok = ok && createEventTables();
+            finishSchema(db, ok);
+        }
+        openMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    int retval;
+    retval = sqlite3_open("boo.db", &db);
+    if (retval != 0) {
+        cout << "Cannot open boo.db: " << sqlite3_errcode(db) << endl;
+        exit(1);
+    }
+    applyPragmas();
+
+    //Creating tables, only when the file is new or was written by an older schema
+
+    if (schemaVersion(db) != SCHEMA_VERSION) {
+        schemaCreated = true;
+        bool ok = execOrLog(db, "BEGIN TRANSACTION;", "beginning schema transaction");
+        ok = ok && execOrLog(db, "CREATE TABLE IF NOT EXISTS events (eventid integer primary key, event_name text, description text, org_name text, event_status text);", "creating event table");
+        ok = ok && createEventTables();
+        if (ok) {
+            createDefaultEvent(db);
+        }
+        finishSchema(db, ok);
+    }
+    openMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+  * Page cache and memory-map sizes chosen with setCacheSize/setMmapSize; SQLite's defaults are kept when unset.
+  */
+void Database::applyPragmas() {
+    stringstream sql;
+    if (cacheKiB > 0) {
+        sql << "PRAGMA cache_size = -" << cacheKiB << ";";
+    }
+    if (mmapBytes >= 0) {
+        sql << "PRAGMA mmap_size = " << mmapBytes << ";";
+    }
+    if (!sql.str().empty()) {
+        execOrLog(db, sql.str().c_str(), "configuring page cache");
+    }
+}
+
+/**
+  * Creates the per-event tables in the main database. Event files carry no foreign key to events,
+  * since SQLite cannot reference a table in another (attached) database.
+  * Returns false as soon as a statement fails.
+  */
+bool Database::createEventTables() {
+    bool keys = (mode == SINGLE_FILE);
+    return execOrLog(db, keys ?
+            "CREATE TABLE IF NOT EXISTS users (userid integer primary key, uuid text, username text, fname text, lname text, eventid int, FOREIGN KEY(eventid) REFERENCES events(eventid));" :
+            "CREATE TABLE IF NOT EXISTS users (userid integer primary key, uuid text, username text, fname text, lname text, eventid int);",
+            "creating users table")
+        && execOrLog(db, keys ?
+            "CREATE TABLE IF NOT EXISTS activities (activityid integer primary key, name text, eventid int, status text, FOREIGN KEY (eventid) REFERENCES events(eventid));" :
+            "CREATE TABLE IF NOT EXISTS activities (activityid integer primary key, name text, eventid int, status text);",
+            "creating activites table")
+        && execOrLog(db, "CREATE TABLE IF NOT EXISTS prerequisites (activityid integer, prereqid integer, FOREIGN KEY(activityid) REFERENCES activities(activityid), FOREIGN KEY(prereqid) REFERENCES activities(activityid));", "creating prereq table")
+        && execOrLog(db, "CREATE TABLE IF NOT EXISTS checkins (checkinid integer PRIMARY KEY, userid int, activityid int, FOREIGN KEY(userid) REFERENCES users(userid), FOREIGN KEY(activityid) REFERENCES activities(activityid));", "creating checkins table")
+        && execOrLog(db, "CREATE TABLE IF NOT EXISTS roster_imports (path text, eventid int, rows int, PRIMARY KEY(path, eventid));", "creating roster_imports table");
+}
+
+/**
+  * PER_EVENT mode: makes sure the catalog holds at least one event, picks the current event
+  * (the lowest eventid unless openEventDatabase chose one) and opens its file with the catalog attached.
+  * The catalog DDL is skipped when its schema version is current.
+  */
+bool Database::openCatalog() {
+    sqlite3* catalog;
+    if (sqlite3_open(CATALOG_FILE, &catalog) != SQLITE_OK) {
+        cout << "Cannot open " << CATALOG_FILE << ": " << sqlite3_errcode(catalog) << endl;
+        return false;
+    }
+    if (schemaVersion(catalog) != SCHEMA_VERSION) {
+        if (execOrLog(catalog, "CREATE TABLE IF NOT EXISTS events (eventid integer primary key, event_name text, description text, org_name text, event_status text);", "creating event table")) {
+            createDefaultEvent(catalog);
+            setSchemaVersion(catalog);
+        }
+    }
+    if (currentEvent == 0) {
+        sqlite3_stmt* s;
+        const char* sql = "SELECT min(eventid) FROM events";
+        if (sqlite3_prepare(catalog, sql, strlen(sql), &s, NULL) == SQLITE_OK) {
+            if (sqlite3_step(s) == SQLITE_ROW) {
+                currentEvent = sqlite3_column_int(s, 0);
+            }
+            sqlite3_finalize(s);
+        }
+    }
+    sqlite3_close(catalog);
+    if (currentEvent == 0) {
+        cout << "No event found in " << CATALOG_FILE << endl;
+        return false;
+    }
+
+    string file = eventFile(currentEvent);
+    if (sqlite3_open(file.c_str(), &db) != SQLITE_OK) {
+        cout << "Cannot open " << file << ": " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    string sql = string("ATTACH DATABASE '") + CATALOG_FILE + "' AS catalog;";
+    return execOrLog(db, sql.c_str(), "attaching the event catalog");
+}
+
 sqlite3* Database::openDatabase() {
     if (!instance) {
         instance = new Database;
@@ -90,12 +286,312 @@ sqlite3* Database::openDatabase() {
     return instance->db;
 }
 
+/**
+  * Returns the connection holding the given event's rows. In PER_EVENT mode this switches the current event
+  * (reopening the connection) when needed; in SINGLE_FILE mode every event shares boo.db.
+  * Returns NULL if the event does not exist or a transaction is still open on another event.
+  */
+sqlite3* Database::openEventDatabase(size_t eventid) {
+    sqlite3* db = openDatabase();
+    if (mode == SINGLE_FILE || eventid == currentEvent) {
+        return db;
+    }
+    if (!sqlite3_get_autocommit(db)) {
+        cout << "Cannot switch to event " << eventid << " while a transaction is open on event " << currentEvent << endl;
+        return NULL;
+    }
+    sqlite3_stmt* s;
+    const char* sql = "SELECT eventid FROM catalog.events WHERE eventid = ?";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return NULL;
+    }
+    sqlite3_bind_int(s, 1, eventid);
+    int found = sqlite3_step(s);
+    sqlite3_finalize(s);
+    if (found != SQLITE_ROW) {
+        cout << "Event " << eventid << " does not exist in the catalog." << endl;
+        return NULL;
+    }
+
+    closeDatabase();
+    currentEvent = eventid;
+    db = openDatabase();
+    if (eventSwitched) {
+        eventSwitched(eventid);
+    }
+    return db;
+}
+
 void Database::closeDatabase() {
     if(instance) { delete instance; }
+    instance = 0;
+    attached.clear();
+}
+
+/**
+  * Selects single-file or per-event storage. Closes an open connection so the next openDatabase() uses the new layout.
+  */
+void Database::setStorageMode(StorageMode m) {
+    if (m == mode) {
+        return;
+    }
+    closeDatabase();
+    mode = m;
+    currentEvent = 0;
+}
+
+Database::StorageMode Database::getStorageMode() {
+    return mode;
+}
+
+/**
+  * Function called after openEventDatabase() switched the current event, with the new event's id;
+  * 0 for none. Anything keyed by ids that are only unique within one event file must be let go there.
+  */
+void Database::setEventSwitchHandler(void (*handler)(size_t eventid)) {
+    eventSwitched = handler;
+}
+
+size_t Database::getCurrentEvent() {
+    openDatabase();
+    return currentEvent;
+}
+
+/**
+  * Page cache size in KiB for connections opened from now on (0 keeps SQLite's default).
+  */
+void Database::setCacheSize(int kib) {
+    cacheKiB = kib;
+}
+
+/**
+  * Bytes of each database file to memory-map for connections opened from now on (-1 keeps SQLite's default, 0 disables).
+  */
+void Database::setMmapSize(long long bytes) {
+    mmapBytes = bytes;
+}
+
+/**
+  * Milliseconds the last open took, and whether it had to run the schema DDL; used for the startup report.
+  */
+double Database::getOpenMilliseconds() {
+    return openMillis;
+}
+
+bool Database::createdSchema() {
+    return schemaCreated;
+}
+
+string Database::eventFile(size_t eventid) {
+    stringstream ss;
+    ss << "event_" << eventid << ".db";
+    return ss.str();
+}
+
+/**
+  * Attaches another event's file for cross-event reports and returns its schema name, e.g. "event_3",
+  * so a report can read event_3.checkins next to main.checkins. Returns "main" for the current event
+  * (and for every event in SINGLE_FILE mode), or an empty string on failure.
+  */
+string Database::attachEvent(size_t eventid) {
+    sqlite3* db = openDatabase();
+    if (mode == SINGLE_FILE || eventid == currentEvent) {
+        return "main";
+    }
+    stringstream name;
+    name << "event_" << eventid;
+    if (attached.count(eventid)) {
+        return name.str();
+    }
+    string file = eventFile(eventid);
+    if (!fileExists(file)) {
+        cout << "No database file for event " << eventid << endl;
+        return "";
+    }
+
+    sqlite3_stmt* s;
+    string sql = "ATTACH DATABASE ? AS " + name.str();
+    if (sqlite3_prepare(db, sql.c_str(), sql.size(), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return "";
+    }
+    sqlite3_bind_text(s, 1, file.c_str(), file.size(), SQLITE_STATIC);
+    int retval = sqlite3_step(s);
+    sqlite3_finalize(s);
+    if (retval != SQLITE_DONE) {
+        cout << "Error attaching " << file << ": " << sqlite3_errmsg(db) << endl;
+        return "";
+    }
+    attached.insert(eventid);
+    return name.str();
+}
+
+bool Database::detachEvent(size_t eventid) {
+    if (!instance || !attached.count(eventid)) {
+        return true;
+    }
+    releaseStatements(instance->db);
+    stringstream sql;
+    sql << "DETACH DATABASE event_" << eventid << ";";
+    if (!execOrLog(instance->db, sql.str().c_str(), "detaching event")) {
+        return false;
+    }
+    attached.erase(eventid);
+    return true;
+}
+
+/**
+  * PER_EVENT mode only: moves the event's file, with any journal or WAL files, into archive_dir (created if missing)
+  * and marks the event "Archived" in the catalog. The current event cannot be archived; switch to another one first.
+  */
+bool Database::archiveEvent(size_t eventid, string archive_dir) {
+    sqlite3* db = openDatabase();
+    if (mode != PER_EVENT) {
+        cout << "Archiving an event requires per-event storage." << endl;
+        return false;
+    }
+    if (eventid == currentEvent) {
+        cout << "Cannot archive the current event " << eventid << endl;
+        return false;
+    }
+    if (!detachEvent(eventid)) {
+        return false;
+    }
+    if (!makeDirectory(archive_dir)) {
+        cout << "Cannot create archive directory " << archive_dir << endl;
+        return false;
+    }
+    string file = eventFile(eventid);
+    if (!moveDatabaseFiles(file, archive_dir + "/" + file)) {
+        return false;
+    }
+
+    sqlite3_stmt* s;
+    const char* sql = "UPDATE catalog.events SET event_status = 'Archived' WHERE eventid = ?";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    sqlite3_bind_int(s, 1, eventid);
+    int retval = sqlite3_step(s);
+    sqlite3_finalize(s);
+    if (retval != SQLITE_DONE) {
+        cout << "Error executing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+  * PER_EVENT mode only: deletes the event's file and removes it from the catalog.
+  */
+bool Database::dropEvent(size_t eventid) {
+    sqlite3* db = openDatabase();
+    if (mode != PER_EVENT) {
+        cout << "Dropping an event requires per-event storage." << endl;
+        return false;
+    }
+    if (eventid == currentEvent) {
+        cout << "Cannot drop the current event " << eventid << endl;
+        return false;
+    }
+    if (!detachEvent(eventid)) {
+        return false;
+    }
+    string file = eventFile(eventid);
+    for (int i = 0; i < SIDECAR_COUNT; i++) {
+        remove((file + SIDECARS[i]).c_str());
+    }
+
+    sqlite3_stmt* s;
+    const char* sql = "DELETE FROM catalog.events WHERE eventid = ?";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    sqlite3_bind_int(s, 1, eventid);
+    int retval = sqlite3_step(s);
+    sqlite3_finalize(s);
+    if (retval != SQLITE_DONE) {
+        cout << "Error executing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    return true;
+}
+
+bool Database::beginTransaction() {
+    char* errmsg;
+    int retval = sqlite3_exec(openDatabase(), "BEGIN TRANSACTION;", NULL, NULL, &errmsg);
+    if (retval != SQLITE_OK) {
+        cout << "Error beginning transaction: " << errmsg << endl;
+        sqlite3_free(errmsg);
+        return false;
+    }
+    return true;
+}
+
+bool Database::commitTransaction() {
+    char* errmsg;
+    int retval = sqlite3_exec(openDatabase(), "COMMIT;", NULL, NULL, &errmsg);
+    if (retval != SQLITE_OK) {
+        cout << "Error committing transaction: " << errmsg << endl;
+        sqlite3_free(errmsg);
+        return false;
+    }
+    return true;
+}
+
+void Database::rollbackTransaction() {
+    sqlite3_exec(openDatabase(), "ROLLBACK;", NULL, NULL, NULL);
+}
+
+/**
+  * Number of check-in rows that repeat an earlier (userid, activityid) pair in the current database,
+  * i.e. the rows a unique check-in index would refuse. -1 if they could not be counted.
+  */
+int Database::repeatedCheckins() {
+    sqlite3* db = openDatabase();
+    sqlite3_stmt* s;
+    const char* sql = "SELECT coalesce(sum(n - 1), 0) FROM (SELECT count(*) AS n FROM checkins GROUP BY userid, activityid HAVING n > 1)";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code " << sqlite3_errcode(db) << endl;
+        return -1;
+    }
+    int repeated = -1;
+    if (sqlite3_step(s) == SQLITE_ROW) {
+        repeated = sqlite3_column_int(s, 0);
+    }
+    sqlite3_finalize(s);
+    return repeated;
+}
+
+/**
+  * Adds (or drops) a unique index on checkins(userid, activityid) in the current database, so SQLite itself
+  * rejects a second check-in of the same user to the same activity. Opt-in; nothing calls it by default.
+  * Existing repeated check-ins are counted and reported, never deleted: the index is refused while any remain.
+  */
+bool Database::setUniqueCheckins(bool unique) {
+    sqlite3* db = openDatabase();
+    if (!unique) {
+        return execOrLog(db, "DROP INDEX IF EXISTS checkins_user_activity;", "dropping unique check-in index");
+    }
+    int repeated = repeatedCheckins();
+    if (repeated != 0) {
+        if (repeated > 0) {
+            cout << "Not adding the unique check-in index: " << repeated
+                 << " check-ins repeat an earlier check-in of the same user to the same activity." << endl;
+        }
+        return false;
+    }
+    return execOrLog(db, "CREATE UNIQUE INDEX IF NOT EXISTS checkins_user_activity ON checkins (userid, activityid);",
+                     "creating unique check-in index");
 }
 
 Database::~Database() {
-    sqlite3_close(db);
+    // statements leaked by callers must not keep the files locked once we switch events
+    releaseStatements(db);
+    sqlite3_close_v2(db);
 }
 
 
@@ -2,23 +2,66 @@
 #define DATABASE_H
 
 #include "database/sqlite3.h"
+#include <string>
+#include <set>
 
 /**
   * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
-  * Singleton Database class that opens a .db file through a static method, creates 5 tables inside of the file.
+  * Singleton Database class that opens a .db file through a static method, creates 6 tables inside of the file.
+  * The schema version is stamped in PRAGMA user_version, so later opens skip the DDL entirely.
+  *
+  * In PER_EVENT storage mode the events table lives in a catalog file (boo_catalog.db) and every event gets its own
+  * event_<id>.db holding its users, activities, prerequisites and checkins. The connection opens the current event's
+  * file as "main" and attaches the catalog as "catalog", so unqualified table names keep working and current-event
+  * queries never read another event's pages. Other events can be attached as "event_<id>" for cross-event reports.
+  * main() selects PER_EVENT when BOO_STORAGE=per-event is set.
   *
   * @author Hayden Estey
   */
 
 class Database {
     public:
+        enum StorageMode { SINGLE_FILE, PER_EVENT };
+
         static sqlite3* openDatabase();
+        static sqlite3* openEventDatabase(size_t eventid);
         static void closeDatabase();
+        static bool beginTransaction();
+        static bool commitTransaction();
+        static void rollbackTransaction();
+        static int repeatedCheckins();
+        static bool setUniqueCheckins(bool);
+
+        static void setCacheSize(int kib);
+        static void setMmapSize(long long bytes);
+        static double getOpenMilliseconds();
+        static bool createdSchema();
+
+        static void setStorageMode(StorageMode mode);
+        static StorageMode getStorageMode();
+        static void setEventSwitchHandler(void (*handler)(size_t eventid));
+        static size_t getCurrentEvent();
+        static std::string eventFile(size_t eventid);
+        static std::string attachEvent(size_t eventid);
+        static bool detachEvent(size_t eventid);
+        static bool archiveEvent(size_t eventid, std::string archive_dir);
+        static bool dropEvent(size_t eventid);
 
     private:
         sqlite3 *db;
         Database();
         ~Database();
+        bool createEventTables();
+        void applyPragmas();
+        bool openCatalog();
         static Database* instance;
+        static StorageMode mode;
+        static size_t currentEvent;
+        static std::set<size_t> attached;
+        static int cacheKiB;
+        static long long mmapBytes;
+        static double openMillis;
+        static bool schemaCreated;
+        static void (*eventSwitched)(size_t);
 };
 #endif
@@ -41,125 +41,178 @@ THE SOFTWARE.
 #include <jni.h>
 #endif
 
+#if defined(GUID_LIBUUID) || defined(GUID_CFUUID)
+#define GUID_URANDOM
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
 using namespace std;
 
+static_assert(sizeof(Guid) == 16, "Guid must be exactly its 16 bytes");
+
+namespace
+{
+  const char hexDigits[] = "0123456789abcdef";
+
+  // where each byte's two hex digits go in the 8-4-4-4-12 form
+  const unsigned char textOffsets[16] =
+    { 0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34 };
+
+  // maps a character to its hex value, or -1
+  struct HexTable
+  {
+    signed char values[256];
+    HexTable()
+    {
+      memset(values, -1, sizeof(values));
+      for (int i = 0; i < 10; i++)
+        values['0' + i] = i;
+      for (int i = 0; i < 6; i++)
+      {
+        values['a' + i] = 10 + i;
+        values['A' + i] = 10 + i;
+      }
+    }
+  };
+  const HexTable hexTable;
+
+  inline int hexValue(char ch)
+  {
+    return hexTable.values[(unsigned char)ch];
+  }
+}
+
 // overload << so that it's easy to convert to a string
 ostream &operator<<(ostream &s, const Guid &guid)
 {
-  return s << hex << setfill('0')
-    << setw(2) << (int)guid._bytes[0]
-    << setw(2) << (int)guid._bytes[1]
-    << setw(2) << (int)guid._bytes[2]
-    << setw(2) << (int)guid._bytes[3]
-    << "-"
-    << setw(2) << (int)guid._bytes[4]
-    << setw(2) << (int)guid._bytes[5]
-    << "-"
-    << setw(2) << (int)guid._bytes[6]
-    << setw(2) << (int)guid._bytes[7]
-    << "-"
-    << setw(2) << (int)guid._bytes[8]
-    << setw(2) << (int)guid._bytes[9]
-    << "-"
-    << setw(2) << (int)guid._bytes[10]
-    << setw(2) << (int)guid._bytes[11]
-    << setw(2) << (int)guid._bytes[12]
-    << setw(2) << (int)guid._bytes[13]
-    << setw(2) << (int)guid._bytes[14]
-    << setw(2) << (int)guid._bytes[15];
+  char text[Guid::StringLength];
+  guid.toChars(text);
+  return s.write(text, Guid::StringLength);
 }
 
-// create a guid from vector of bytes
-Guid::Guid(const vector<unsigned char> &bytes)
+void Guid::toChars(char *out) const
 {
-  _bytes = bytes;
+  out[8] = out[13] = out[18] = out[23] = '-';
+  for (int i = 0; i < 16; i++)
+  {
+    out[textOffsets[i]] = hexDigits[_bytes[i] >> 4];
+    out[textOffsets[i] + 1] = hexDigits[_bytes[i] & 0x0f];
+  }
 }
 
-// create a guid from array of bytes
-Guid::Guid(const unsigned char *bytes)
+string Guid::str() const
 {
-  _bytes.assign(bytes, bytes + 16);
+  string text(StringLength, '-');
+  toChars(&text[0]);
+  return text;
 }
 
-// converts a single hex char to a number (0 - 15)
-unsigned char hexDigitToChar(char ch)
+bool Guid::parse(const char *text, size_t length, Guid &result)
 {
-  if (ch > 47 && ch < 58)
-    return ch - 48;
-
-  if (ch > 96 && ch < 103)
-    return ch - 87;
-
-  if (ch > 64 && ch < 71)
-    return ch - 55;
-
-  return 0;
+  bool dashed = (length == StringLength);
+  if (!dashed && length != 32)
+    return false;
+  if (dashed && (text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-'))
+    return false;
+
+  Bytes bytes;
+  int bad = 0;
+  for (int i = 0; i < 16; i++)
+  {
+    size_t at = dashed ? textOffsets[i] : 2 * i;
+    int hi = hexValue(text[at]);
+    int lo = hexValue(text[at + 1]);
+    bad |= hi | lo;
+    bytes[i] = (unsigned char)((hi << 4) | (lo & 0x0f));
+  }
+  if (bad < 0)
+    return false;
+  result._bytes = bytes;
+  return true;
 }
 
-// converts the two hexadecimal characters to an unsigned char (a byte)
-unsigned char hexPairToChar(char a, char b)
+// create a guid from vector of bytes
+Guid::Guid(const vector<unsigned char> &bytes) : _bytes()
 {
-  return hexDigitToChar(a) * 16 + hexDigitToChar(b);
+  memcpy(_bytes.data(), bytes.data(), bytes.size() < 16 ? bytes.size() : 16);
 }
 
-// create a guid from string
-Guid::Guid(const string &fromString)
+// create a guid from array of bytes
+Guid::Guid(const unsigned char *bytes)
 {
-  _bytes.clear();
+  memcpy(_bytes.data(), bytes, 16);
+}
 
-  char charOne, charTwo;
-  bool lookingForFirstChar = true;
+// create a guid from string; dashes are skipped, as are any digits past the
+// sixteenth byte
+Guid::Guid(const string &fromString) : _bytes()
+{
+  if (parse(fromString.data(), fromString.size(), *this))
+    return;
 
-  for (const char &ch : fromString)
+  size_t count = 0;
+  int first = -1;
+  for (size_t i = 0; i < fromString.size() && count < 16; i++)
   {
+    char ch = fromString[i];
     if (ch == '-')
       continue;
 
-    if (lookingForFirstChar)
-    {
-      charOne = ch;
-      lookingForFirstChar = false;
-    }
+    int value = hexValue(ch);
+    if (value < 0)
+      value = 0;
+    if (first < 0)
+      first = value;
     else
     {
-      charTwo = ch;
-      auto byte = hexPairToChar(charOne, charTwo);
-      _bytes.push_back(byte);
-      lookingForFirstChar = true;
+      _bytes[count++] = (unsigned char)(first * 16 + value);
+      first = -1;
     }
   }
-
-}
-
-// create empty guid
-Guid::Guid()
-{
-  _bytes = vector<unsigned char>(16, 0);
-}
-
-// copy constructor
-Guid::Guid(const Guid &other)
-{
-  _bytes = other._bytes;
-}
-
-// overload assignment operator
-Guid &Guid::operator=(const Guid &other)
-{
-  _bytes = other._bytes;
-  return *this;
 }
 
-// overload equality operator
-bool Guid::operator==(const Guid &other) const
+vector<Guid> GuidGenerator::newGuids(size_t count)
 {
-  return _bytes == other._bytes;
+  vector<Guid> guids(count);
+  if (count)
+    newGuids(&guids[0], count);
+  return guids;
 }
 
-// overload inequality operator
-bool Guid::operator!=(const Guid &other) const
+void GuidGenerator::newGuids(Guid *out, size_t count)
 {
-  return !((*this) == other);
+#ifdef GUID_URANDOM
+  // one read for the whole batch instead of a generator call per guid
+  unsigned char *raw = reinterpret_cast<unsigned char *>(out);
+  size_t want = count * 16, have = 0;
+  int fd = open("/dev/urandom", O_RDONLY);
+  if (fd >= 0)
+  {
+    while (have < want)
+    {
+      ssize_t n = read(fd, raw + have, want - have);
+      if (n <= 0)
+        break;
+      have += n;
+    }
+    close(fd);
+  }
+  if (have == want)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      Guid::Bytes &b = out[i]._bytes;
+      b[6] = (b[6] & 0x0f) | 0x40; // version 4
+      b[8] = (b[8] & 0x3f) | 0x80; // RFC 4122 variant
+    }
+    return;
+  }
+#endif
+  for (size_t i = 0; i < count; i++)
+    out[i] = newGuid();
 }
 
 // This is the linux friendly implementation, but it could work on other
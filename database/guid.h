@@ -26,21 +26,35 @@ THE SOFTWARE.
 
 #include <iostream>
 #include <vector>
-#include <sstream>
+#include <array>
 #include <string>
-#include <iomanip>
+#include <cstddef>
+#include <functional>
 
 #ifdef GUID_ANDROID
 #include <jni.h>
 #endif
 
+// std::array element access is only constexpr from C++14 on; with C++11 the
+// comparison and hashing helpers below are plain inline functions.
+#if __cplusplus >= 201402L
+#define GUID_CONSTEXPR constexpr
+#else
+#define GUID_CONSTEXPR inline
+#endif
+
 // Class to represent a GUID/UUID. Each instance acts as a wrapper around a
 // 16 byte value that can be passed around by value. It also supports
-// conversion to string (via the stream operator <<) and conversion from a
-// string via constructor.
+// conversion to string (via the stream operator << or str()) and conversion
+// from a string via constructor. The bytes are stored inline, so copying a
+// Guid never allocates.
 class Guid
 {
   public:
+    typedef std::array<unsigned char, 16> Bytes;
+
+    // length of the canonical 8-4-4-4-12 text form
+    static const size_t StringLength = 36;
 
     // create a guid from vector of bytes
     Guid(const std::vector<unsigned char> &bytes);
@@ -51,28 +65,62 @@ class Guid
     // create a guid from string
     Guid(const std::string &fromString);
 
-    // create empty guid
-    Guid();
+    // create a guid from its bytes
+    constexpr explicit Guid(const Bytes &bytes) : _bytes(bytes) { }
 
-    // copy constructor
-    Guid(const Guid &other);
+    // create empty guid
+    constexpr Guid() : _bytes() { }
 
-    // overload assignment operator
-    Guid &operator=(const Guid &other);
+    GUID_CONSTEXPR const Bytes &bytes() const { return _bytes; }
 
     // overload equality and inequality operator
-    bool operator==(const Guid &other) const;
-    bool operator!=(const Guid &other) const;
+    GUID_CONSTEXPR bool operator==(const Guid &other) const { return compare(other) == 0; }
+    GUID_CONSTEXPR bool operator!=(const Guid &other) const { return compare(other) != 0; }
+    GUID_CONSTEXPR bool operator<(const Guid &other) const { return compare(other) < 0; }
+
+    // byte-wise ordering, negative/zero/positive like memcmp
+    GUID_CONSTEXPR int compare(const Guid &other, size_t i = 0) const
+    {
+      return i == 16 ? 0 :
+        _bytes[i] != other._bytes[i] ? (_bytes[i] < other._bytes[i] ? -1 : 1) :
+        compare(other, i + 1);
+    }
+
+    // FNV-1a over the 16 bytes
+    GUID_CONSTEXPR size_t hash() const { return size_t(fnv1a(0, 14695981039346656037ULL)); }
+
+    // writes the 36 character lower-case text form to out (no terminator)
+    void toChars(char *out) const;
+
+    // the 36 character lower-case text form
+    std::string str() const;
+
+    // parses the canonical 36 character form (or 32 hex digits without
+    // dashes); returns false and leaves result untouched on malformed input
+    static bool parse(const char *text, size_t length, Guid &result);
 
   private:
+    friend class GuidGenerator;
 
-    // actual data
-    std::vector<unsigned char> _bytes;
+    GUID_CONSTEXPR unsigned long long fnv1a(size_t i, unsigned long long h) const
+    {
+      return i == 16 ? h : fnv1a(i + 1, (h ^ _bytes[i]) * 1099511628211ULL);
+    }
 
-    // make the << operator a friend so it can access _bytes
-    friend std::ostream &operator<<(std::ostream &s, const Guid &guid);
+    // actual data
+    Bytes _bytes;
 };
 
+std::ostream &operator<<(std::ostream &s, const Guid &guid);
+
+namespace std
+{
+  template <> struct hash<Guid>
+  {
+    size_t operator()(const Guid &guid) const { return guid.hash(); }
+  };
+}
+
 // Class that can create new guids. The only reason this exists instead of
 // just a global "newGuid" function is because some platforms will require
 // that there is some attached context. In the case of android, we need to
@@ -91,6 +139,12 @@ class GuidGenerator
 
     Guid newGuid();
 
+    // fills out[0..count) with random (version 4) guids. Where the system
+    // has /dev/urandom this is a single entropy read for the whole batch,
+    // otherwise it falls back to newGuid() per element.
+    void newGuids(Guid *out, size_t count);
+    std::vector<Guid> newGuids(size_t count);
+
 #ifdef GUID_ANDROID
   private:
     JNIEnv *_env;
@@ -0,0 +1,86 @@
+#include "database/recentscans.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+  * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
+  * Recent scans are kept per activity in a hash map from badge UUID to the time it was last seen.
+  * Expired entries are swept once the map has grown by SWEEP_INTERVAL insertions.
+  */
+
+typedef chrono::steady_clock Clock;
+typedef unordered_map<string, Clock::time_point> ScanTimes;
+
+static const size_t SWEEP_INTERVAL = 1024;
+
+static mutex scansMutex;
+static unordered_map<size_t, ScanTimes> scans;
+static Clock::duration window = chrono::seconds(10);
+static size_t insertsSinceSweep = 0;
+
+static void sweep(Clock::time_point now) {
+    for (unordered_map<size_t, ScanTimes>::iterator a = scans.begin(); a != scans.end(); ++a) {
+        ScanTimes& times = a->second;
+        for (ScanTimes::iterator t = times.begin(); t != times.end(); ) {
+            if (now - t->second >= window) {
+                t = times.erase(t);
+            } else {
+                ++t;
+            }
+        }
+    }
+    insertsSinceSweep = 0;
+}
+
+/**
+  * Returns true if the badge has not been seen for this activity within the window, and records the scan.
+  */
+bool RecentScans::accept(const string& uuid, size_t activityid) {
+    Clock::time_point now = Clock::now();
+    lock_guard<mutex> lock(scansMutex);
+
+    ScanTimes& times = scans[activityid];
+    ScanTimes::iterator t = times.find(uuid);
+    if (t != times.end()) {
+        bool recent = now - t->second < window;
+        t->second = now;
+        return !recent;
+    }
+
+    times.insert(make_pair(uuid, now));
+    if (++insertsSinceSweep >= SWEEP_INTERVAL) {
+        sweep(now);
+    }
+    return true;
+}
+
+/**
+  * Drops a scan so the next one is accepted, e.g. when the check-in it triggered failed.
+  */
+void RecentScans::forget(const string& uuid, size_t activityid) {
+    lock_guard<mutex> lock(scansMutex);
+    unordered_map<size_t, ScanTimes>::iterator a = scans.find(activityid);
+    if (a != scans.end()) {
+        a->second.erase(uuid);
+    }
+}
+
+void RecentScans::setWindow(int milliseconds) {
+    lock_guard<mutex> lock(scansMutex);
+    window = chrono::milliseconds(milliseconds > 0 ? milliseconds : 0);
+}
+
+int RecentScans::getWindow() {
+    lock_guard<mutex> lock(scansMutex);
+    return (int)chrono::duration_cast<chrono::milliseconds>(window).count();
+}
+
+void RecentScans::clear() {
+    lock_guard<mutex> lock(scansMutex);
+    scans.clear();
+    insertsSinceSweep = 0;
+}
@@ -0,0 +1,22 @@
+#ifndef RECENTSCANS_H
+#define RECENTSCANS_H
+
+#include <string>
+
+/**
+  * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
+  * In-memory filter that suppresses repeated scans of the same badge for the same activity within a time window,
+  * so a badge held in front of the camera is rejected without touching the database.
+  * The window slides: every rejected scan restarts it.
+  */
+
+class RecentScans {
+    public:
+        static bool accept(const std::string& uuid, size_t activityid);
+        static void forget(const std::string& uuid, size_t activityid);
+        static void setWindow(int milliseconds);
+        static int getWindow();
+        static void clear();
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "database/sqlite3.h"
+#include "database/rosterimport.h"
+#include "database/database.h"
+#include <iostream>
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+/**
+  * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
+  * Progress rows for roster imports, keyed by roster file path and event.
+  */
+
+size_t RosterImport::loadProgress(string path, size_t eventid) {
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for loading import progress" << endl;
+        return 0;
+    }
+    sqlite3_stmt* s;
+    int retval;
+    size_t rows = 0;
+
+    const char* sql = "SELECT rows FROM roster_imports WHERE path = ? AND eventid = ?";
+    retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
+    if (retval != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
+        return 0;
+    }
+    sqlite3_bind_text(s, 1, path.c_str(), path.size(), SQLITE_STATIC);
+    sqlite3_bind_int(s, 2, eventid);
+    if (sqlite3_step(s) == SQLITE_ROW) {
+        rows = (size_t)sqlite3_column_int(s, 0);
+    }
+    sqlite3_finalize(s);
+    return rows;
+}
+
+bool RosterImport::saveProgress(string path, size_t eventid, size_t rows) {
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for saving import progress" << endl;
+        return false;
+    }
+    sqlite3_stmt* s;
+    int retval;
+
+    const char* sql = "INSERT OR REPLACE INTO roster_imports (path, eventid, rows) values (?, ?, ?)";
+    retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
+    if (retval != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
+        return false;
+    }
+    sqlite3_bind_text(s, 1, path.c_str(), path.size(), SQLITE_STATIC);
+    sqlite3_bind_int(s, 2, eventid);
+    sqlite3_bind_int(s, 3, rows);
+    if (sqlite3_step(s) != SQLITE_DONE) {
+        cout << "Error executing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
+        sqlite3_finalize(s);
+        return false;
+    }
+    sqlite3_finalize(s);
+    return true;
+}
+
+void RosterImport::clearProgress(string path, size_t eventid) {
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for clearing import progress" << endl;
+        return;
+    }
+    sqlite3_stmt* s;
+
+    const char* sql = "DELETE FROM roster_imports WHERE path = ? AND eventid = ?";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
+        return;
+    }
+    sqlite3_bind_text(s, 1, path.c_str(), path.size(), SQLITE_STATIC);
+    sqlite3_bind_int(s, 2, eventid);
+    if (sqlite3_step(s) != SQLITE_DONE) {
+        cout << "Error executing SQL statement " << sql << ", error code: " << sqlite3_errcode(db) << endl;
+    }
+    sqlite3_finalize(s);
+}
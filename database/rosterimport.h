@@ -0,0 +1,19 @@
+#ifndef ROSTERIMPORT_H
+#define ROSTERIMPORT_H
+
+#include <string>
+
+/**
+  * Built as part of the Boo QR Logger Project, a class project from the Spring 2017 Software Development I class at Stetson University.
+  * Tracks how many rows of a roster file have been committed to the users table, so an interrupted import can resume.
+  * saveProgress() is meant to run inside the same transaction as the rows it counts.
+  */
+
+class RosterImport {
+    public:
+        static size_t loadProgress(std::string path, size_t eventid);
+        static bool saveProgress(std::string path, size_t eventid, size_t rows);
+        static void clearProgress(std::string path, size_t eventid);
+};
+
+#endif
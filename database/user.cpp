@@ -28,15 +28,16 @@ User::User(size_t _userid, string _uuid, string _username, string _fname, string
 }
 
 User* User::createUser(string username, string fname, string lname, size_t eventid) {
-    sqlite3* db = Database::openDatabase();
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for creating a user" << endl;
+        return NULL;
+    }
     int retval;
     sqlite3_stmt* s;
 
     GuidGenerator generator;
-    Guid g = generator.newGuid();
-    stringstream guidss;
-    guidss << g;
-    string uuid = guidss.str();
+    string uuid = generator.newGuid().str();
 
     const char* sql = "SELECT eventid FROM events WHERE eventid = ?";
     retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
@@ -118,6 +119,79 @@ User* User::createUser(string username, string fname, string lname, size_t event
     return u;
 }
 
+/**
+  * Inserts many users into one event with a single prepared statement, returning their UUIDs in order.
+  * Callers importing large rosters should wrap this in Database::beginTransaction()/commitTransaction(),
+  * otherwise SQLite commits (and syncs) after every row. Returns an empty vector on failure.
+  */
+vector<string> User::createUsers(const vector<UserInfo>& users, size_t eventid) {
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for creating users" << endl;
+        return vector<string>();
+    }
+    int retval;
+    sqlite3_stmt* s;
+    vector<string> uuids;
+
+    const char* sql = "SELECT eventid FROM events WHERE eventid = ?";
+    retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
+    if (retval != SQLITE_OK) {
+        cout << "Error in preparing select statement for events: error code " << sqlite3_errcode(db) << endl;
+        return uuids;
+    }
+    retval = sqlite3_bind_int(s, 1, eventid);
+    if (retval != SQLITE_OK) {
+        cout << "Error binding int to SQL statement " << sql << endl;
+        sqlite3_finalize(s);
+        return uuids;
+    }
+    if (sqlite3_step(s) != SQLITE_ROW) {
+        cout << "Error executing SQL statement " << sql << " with error code " << sqlite3_errcode(db) << endl;
+        cout << "Check to make sure that the event exists in the database." << endl;
+        sqlite3_finalize(s);
+        return uuids;
+    }
+    sqlite3_finalize(s);
+
+    sql = "INSERT INTO users (uuid, username, fname, lname, eventid) values (?, ?, ?, ?, ?)";
+    retval = sqlite3_prepare(db, sql, strlen(sql), &s, NULL);
+    if (retval != SQLITE_OK) {
+        cout << "Error in preparing insert statement for users: error code " << sqlite3_errcode(db) << endl;
+        return uuids;
+    }
+
+    GuidGenerator generator;
+    vector<Guid> guids = generator.newGuids(users.size());
+    vector<string> created;
+    created.reserve(users.size());
+    for (size_t i = 0; i < users.size(); i++) {
+        string uuid = guids[i].str();
+        const UserInfo& u = users[i];
+
+        if (sqlite3_bind_text(s, 1, uuid.c_str(), uuid.size(), SQLITE_TRANSIENT) != SQLITE_OK ||
+            sqlite3_bind_text(s, 2, u.username.c_str(), u.username.size(), SQLITE_STATIC) != SQLITE_OK ||
+            sqlite3_bind_text(s, 3, u.fname.c_str(), u.fname.size(), SQLITE_STATIC) != SQLITE_OK ||
+            sqlite3_bind_text(s, 4, u.lname.c_str(), u.lname.size(), SQLITE_STATIC) != SQLITE_OK ||
+            sqlite3_bind_int(s, 5, eventid) != SQLITE_OK) {
+            cout << "Error binding values to SQL statement " << sql << endl;
+            sqlite3_finalize(s);
+            return uuids;
+        }
+        if (sqlite3_step(s) != SQLITE_DONE) {
+            cout << "Error executing sql statement " << sql << ": error code " << sqlite3_errcode(db) << endl;
+            sqlite3_finalize(s);
+            return uuids;
+        }
+        sqlite3_reset(s);
+        created.push_back(uuid);
+    }
+    sqlite3_finalize(s);
+
+    uuids.swap(created);
+    return uuids;
+}
+
 User* User::loadUserById(size_t id) {
     sqlite3* db = Database::openDatabase();
     sqlite3_stmt* s;
@@ -308,6 +382,32 @@ vector<User*> User::getAllUsers() {
     }
     return results;
 }
+vector<string> User::getUUIDsByEventId(size_t eventid) {
+    sqlite3* db = Database::openEventDatabase(eventid);
+    if (db == NULL) {
+        cout << "Cannot open event " << eventid << " for loading badge ids" << endl;
+        return vector<string>();
+    }
+    sqlite3_stmt *s;
+    vector<string> results;
+
+    const char *sql = "SELECT uuid FROM users WHERE eventid = ?";
+    if (sqlite3_prepare(db, sql, strlen(sql), &s, NULL) != SQLITE_OK) {
+        cout << "Error preparing select statement for users " << sqlite3_errcode(db) << endl;
+        return results;
+    }
+    if (sqlite3_bind_int(s, 1, eventid) != SQLITE_OK) {
+        cout << "Error binding int to SQL statement " << sql << endl;
+        sqlite3_finalize(s);
+        return results;
+    }
+    while (sqlite3_step(s) == SQLITE_ROW) {
+        results.push_back(string(reinterpret_cast<const char*>(sqlite3_column_text(s, 0))));
+    }
+    sqlite3_finalize(s);
+    return results;
+}
+
 User* User::getUserWithUUID(std::string guid) {
 
     sqlite3* db = Database::openDatabase();
@@ -338,6 +438,7 @@ User* User::getUserWithUUID(std::string guid) {
         _lname = string(reinterpret_cast<const char*>(sqlite3_column_text(s, 4)));
         _eventid = sqlite3_column_int(s, 5);
     }
+    sqlite3_finalize(s);
 
     User* a = new User(id, _uuid, _username, _fname, _lname, _eventid);
 
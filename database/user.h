@@ -11,10 +11,17 @@
   * @author Hayden Estey
   */
 
+struct UserInfo {
+    std::string username;
+    std::string fname;
+    std::string lname;
+};
+
 class User {
     public:
         ~User();
         static User* createUser(std::string username, std::string fname, std::string lname, size_t eventid);
+        static std::vector<std::string> createUsers(const std::vector<UserInfo>& users, size_t eventid);
         static User* loadUserById(size_t id);
         size_t getUserId();
         std::string getUUID();
@@ -27,6 +34,7 @@ class User {
         void setUserLname(std::string);
         static std::vector<User*> searchByLastName(std::string);
         static std::vector<User*> getAllUsers();
+        static std::vector<std::string> getUUIDsByEventId(size_t eventid);
         static User* getUserWithUUID(std::string);
         
     private:
@@ -4,6 +4,13 @@
 #include "gui/activitycreatewindow.h"
 #include "gui/listactivities.h"
 #include "gui/user_list.h"
+#include "RosterImporter.h"
+#include <QFileDialog>
+#include <QProgressDialog>
+#include <QMessageBox>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 EventAdminWindow::EventAdminWindow(QWidget *parent) :
     QDialog(parent),
@@ -50,6 +57,7 @@ void EventAdminWindow::on_activeEventButton_released()
 void EventAdminWindow::change_button_status(bool status) {
     ui->addActsButton->setEnabled(status);
     ui->addUsersButton->setEnabled(status);
+    ui->importRosterButton->setEnabled(status);
 
 
 }
@@ -79,3 +87,36 @@ void EventAdminWindow::on_listUsersButton_clicked()
   userList.setModal(true);
   userList.exec();
 }
+
+void EventAdminWindow::on_importRosterButton_released()
+{
+    QString path = QFileDialog::getOpenFileName(this, tr("Import Roster"), QString(), tr("CSV files (*.csv);;All files (*)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QProgressDialog progress(tr("Importing roster..."), QString(), 0, 100, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    // the import runs on a pool thread; the progress signals are queued back to this one
+    RosterImporter importer(path, 1);
+    connect(&importer, &RosterImporter::progress, &progress, [&progress](int percent, int rows, int badges) {
+        progress.setLabelText(tr("Imported %1 users, %2 badges written").arg(rows).arg(badges));
+        progress.setValue(percent);
+    });
+
+    QFutureWatcher<bool> watcher;
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::run(&importer, &RosterImporter::run));
+    loop.exec();
+
+    bool ok = watcher.result();
+    progress.setValue(100);
+    if (ok) {
+        QMessageBox::information(this, tr("Import Roster"), tr("Imported %1 users.").arg(importer.rowsImported()));
+    } else {
+        QMessageBox::warning(this, tr("Import Roster"), importer.errorString());
+    }
+}
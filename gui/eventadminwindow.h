@@ -30,6 +30,8 @@ private slots:
 
     void on_listUsersButton_clicked();
 
+    void on_importRosterButton_released();
+
 
 private:
     Ui::EventAdminWindow *ui;
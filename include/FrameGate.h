@@ -0,0 +1,64 @@
+#ifndef FRAMEGATE_H
+#define FRAMEGATE_H
+
+#include <QtGlobal>
+
+/**
+  * Cheap checks that decide whether a viewfinder frame is worth decoding.
+  * A frame is skipped when it is too blurred to read (variance of the Laplacian on a sparse grid),
+  * when it is badly exposed, or when one pass over a band of rows finds nothing with the 1:1:3:1:1
+  * run lengths of a QR finder pattern. The whole check reads a few percent of the pixels.
+  */
+class FrameGate {
+	public:
+		enum Verdict { Pass, Blurred, Dark, Bright, NoFinder, VerdictCount };
+
+		struct Thresholds {
+			Thresholds();
+			// variance of the Laplacian below which a frame is blurred; 0 disables the check
+			double minSharpness;
+			// mean luminance outside [minMean, maxMean] is too dark or too bright
+			int minMean;
+			int maxMean;
+			// largest fraction of samples allowed to be clipped (below 8 or above 247)
+			double maxClipped;
+			// finder pattern candidates a frame needs; 0 keeps frames that may hold a 1D barcode
+			int minFinderCandidates;
+			// distance between rows searched for finder patterns; must not exceed the height of
+			// the 3 module centre of the smallest finder pattern that should still be read
+			int rowStep;
+		};
+
+		FrameGate();
+		explicit FrameGate(const Thresholds &thresholds);
+
+		void setThresholds(const Thresholds &t) { thresholds = t; }
+		const Thresholds &getThresholds() const { return thresholds; }
+
+		// luma points at the first luminance sample; pixelStride is the distance between samples,
+		// 1 for a Y or grey plane and e.g. 4 for the green bytes of a 32-bit RGB frame
+		Verdict check(const uchar *luma, int width, int height, int bytesPerLine, int pixelStride = 1);
+
+		// measurements of the last frame checked
+		double lastSharpness() const { return sharpness; }
+		int lastMean() const { return mean; }
+		int lastFinderCandidates() const { return finderCandidates; }
+
+		static const char *verdictName(Verdict v);
+
+	private:
+		void measureGrid(const uchar *luma, int width, int height, int bytesPerLine, int pixelStride);
+		int countFinderCandidates(const uchar *luma, int width, int height, int bytesPerLine,
+				int pixelStride, int enough) const;
+		bool verticalFinder(const uchar *luma, int height, int bytesPerLine, int pixelStride,
+				int x, int y, int centreRun) const;
+
+		Thresholds thresholds;
+		double sharpness;
+		int mean;
+		double darkClipped;
+		double brightClipped;
+		int finderCandidates;
+};
+
+#endif
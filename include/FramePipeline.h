@@ -0,0 +1,102 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVideoFrame>
+#include <QString>
+#include <QList>
+#include <map>
+
+#include "FrameGate.h"
+#include "QRScanner.h"
+
+/**
+  * Decodes video frames on a pool of worker threads.
+  * Frames wait in a bounded ring; when it is full the oldest frame is dropped, and a free worker
+  * always takes the newest frame, dropping the ones queued before it, so latency stays bounded
+  * however slow decoding is. Each worker decodes with its own QZXing (see QRScanner::decoder()),
+  * which therefore sees an irregular subset of the frames; it is told each frame's sequence number
+  * so that its tracking can allow for the frames it did not see.
+  * Results are delivered through frameDecoded() in the order the frames were pushed.
+  * With the gate on, a worker first runs FrameGate over the frame and skips decoding frames it
+  * rejects; they are still reported, with an empty result, and counted by reason in stats().
+  */
+class FramePipeline : public QObject
+{
+	Q_OBJECT
+
+	public:
+		struct Stats {
+			quint64 pushed;
+			quint64 dropped;
+			quint64 decoded;
+			quint64 found;
+			// frames the gate kept from the decoder, in total and by reason
+			quint64 skipped;
+			quint64 blurred;
+			quint64 badlyExposed;
+			quint64 noFinder;
+		};
+
+		FramePipeline(int workers = 1, int capacity = 2, QObject *parent = 0);
+		~FramePipeline();
+
+		// Called from the thread producing frames; never blocks on decoding.
+		void push(const QVideoFrame &frame);
+		// Drops queued frames and waits for frames being decoded to finish.
+		void flush();
+		// Applies to frames taken after the call. The default thresholds suit the formats QRScanner reads.
+		void setGate(bool enabled, const FrameGate::Thresholds &thresholds = QRScanner::gateThresholds());
+
+		int workerCount() const { return workers.size(); }
+		Stats stats();
+
+	signals:
+		// Emitted from a worker thread, once per decoded frame, in push order.
+		void frameDecoded(quint64 sequence, const QString &result);
+
+	private:
+		struct Frame {
+			quint64 sequence;
+			QVideoFrame frame;
+			bool gated;
+		};
+
+		class Worker : public QThread {
+			public:
+				Worker(FramePipeline *owner) : owner(owner) {}
+			protected:
+				void run();
+			private:
+				FramePipeline *owner;
+		};
+
+		bool take(Frame &frame, FrameGate &gate);
+		void finish(quint64 sequence, const QString &result, FrameGate::Verdict verdict);
+
+		QList<Worker*> workers;
+		int capacity;
+
+		QMutex mutex;
+		QWaitCondition frameReady;
+		QWaitCondition idle;
+		QList<Frame> ring;
+		quint64 nextSequence;
+		bool stopping;
+		bool gating;
+		FrameGate::Thresholds gateThresholds;
+
+		// frames taken by a worker, keyed by sequence; done ones wait here until all older ones are done
+		struct Pending {
+			bool done;
+			QString result;
+		};
+		std::map<quint64, Pending> pending;
+
+		Stats counters;
+};
+
+#endif
@@ -4,12 +4,17 @@
 #include <QCamera>
 #include <QCameraImageCapture>
 #include <QMediaRecorder>
+#include <QVideoProbe>
+#include <QElapsedTimer>
+#include "FramePipeline.h"
 #include "database/activity.h"
 #include "gui/activitywindow.h"
 
 #include <QMainWindow>
 
 namespace Ui { class Camera; }
+class QLabel;
+class QTimer;
 
 class Camera : public QMainWindow
 {
@@ -19,6 +24,9 @@ class Camera : public QMainWindow
         Camera(QWidget*, Activity*, ActivityWindow*);
 		~Camera();
 
+		// decodes attempted per second while scanning continuously
+		void setScanRate(int framesPerSecond);
+
 	private slots:
 		void setCamera(const QCameraInfo &cameraInfo);
 
@@ -60,6 +68,11 @@ class Camera : public QMainWindow
 		void imageSaved(int id, const QString &fileName);
 
         void on_Cancel_released();
+		void on_continuousButton_toggled(bool checked);
+
+		void processFrame(const QVideoFrame &frame);
+		void handleFrameDecoded(quint64 sequence, const QString &result);
+		void updateScanStats();
 
 protected:
 		void keyPressEvent(QKeyEvent *event);
@@ -67,6 +80,8 @@ protected:
 		void closeEvent(QCloseEvent *event);
 
 	private:
+		bool checkInBadge(const QString &result, bool interactive);
+
 		Ui::Camera *ui;
         Activity* current;
         ActivityWindow* win;
@@ -74,6 +89,20 @@ protected:
 		QCamera *camera;
 		QCameraImageCapture *imageCapture;
 		QMediaRecorder* mediaRecorder;
+		QVideoProbe* probe;
+
+		// continuous scanning
+		bool scanning;
+		int scanInterval;
+		QElapsedTimer sinceLastDecode;
+		QElapsedTimer statsClock;
+		FramePipeline* pipeline;
+		QTimer* statsTimer;
+		QLabel* statsLabel;
+		int framesSeen;
+		FramePipeline::Stats lastStats;
+		FramePipeline::Stats scanStart;
+		int checkins;
 
 		QImageEncoderSettings imageSettings;
 		QAudioEncoderSettings audioSettings;
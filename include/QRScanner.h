@@ -3,12 +3,23 @@
 
 #include <QString>
 #include <QImage>
+#include <QVideoFrame>
+
+#include "FrameGate.h"
+
+class QZXing;
 
 class QRScanner {
 	public:
 		QRScanner() {}
 		QString decode(QImage);
 		QString decodeFromFile(QString);
+		// Decodes a camera frame in tracking mode; sequence numbers the frames of the camera in order.
+		// With a gate, frames it rejects are not decoded; the verdict is stored in *verdict.
+		QString decodeFrame(QVideoFrame, quint64 sequence, FrameGate *gate = 0, FrameGate::Verdict *verdict = 0);
+		static QZXing* decoder();
+		// gate thresholds suited to the formats decoder() reads
+		static FrameGate::Thresholds gateThresholds();
 };
 
 #endif
@@ -0,0 +1,43 @@
+#ifndef ROSTERIMPORTER_H
+#define ROSTERIMPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <string>
+#include <vector>
+
+class RosterImporter : public QObject {
+	Q_OBJECT
+
+	public:
+		RosterImporter(QString csvPath, size_t eventid, QString badgeDir = "img", QObject* parent = 0);
+		~RosterImporter();
+		void setBatchSize(int);
+		bool run();
+		int rowsImported() const;
+		int badgesWritten() const;
+		QString errorString() const;
+
+	signals:
+		void progress(int percent, int rowsImported, int badgesWritten);
+
+	private:
+		void queueBadges(const std::vector<std::string>&);
+		void waitForBadges(int percent);
+		static QStringList parseCsvLine(const QString&);
+
+		QString path;
+		size_t eventid;
+		QString badgeDir;
+		int batchSize;
+		int rows;
+		QAtomicInt badges;
+		QString error;
+		// renders badges; its own, so the thread running run() never waits on tasks queued behind it
+		QThreadPool pool;
+};
+
+#endif
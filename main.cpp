@@ -1,6 +1,7 @@
 #include "QRCapture.h"
 #include "gui/mainwindow.h"
 #include "database/database.h"
+#include "database/recentscans.h"
 #include <QApplication>
 #include <cstdlib>
 #include <iostream>
@@ -10,12 +11,49 @@
 
 using namespace std;
 
+static bool uniqueCheckins = false;
+
+// activity ids are only unique within one event file, so scans remembered for one event mean nothing in the next;
+// the opt-in unique check-in index is per file too
+static void switchEvent(size_t)
+{
+    RecentScans::clear();
+    if (uniqueCheckins) {
+        Database::setUniqueCheckins(true);
+    }
+}
+
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startup;
+    startup.start();
     QApplication a(argc, argv);
+
+    // kiosk tuning, e.g. BOO_CACHE_KB=8192 BOO_MMAP_MB=64
+    if (qEnvironmentVariableIsSet("BOO_CACHE_KB")) {
+        Database::setCacheSize(qgetenv("BOO_CACHE_KB").toInt());
+    }
+    if (qEnvironmentVariableIsSet("BOO_MMAP_MB")) {
+        Database::setMmapSize(qgetenv("BOO_MMAP_MB").toLongLong() * 1024 * 1024);
+    }
+    // BOO_STORAGE=per-event keeps every event in its own file next to a boo_catalog.db
+    if (qgetenv("BOO_STORAGE") == "per-event") {
+        Database::setStorageMode(Database::PER_EVENT);
+    }
+    Database::setEventSwitchHandler(switchEvent);
+    qint64 appReady = startup.elapsed();
     Database::openDatabase();
+    // BOO_UNIQUE_CHECKINS=1 adds the unique check-in index; refused while repeated check-ins are stored
+    if (qgetenv("BOO_UNIQUE_CHECKINS") == "1") {
+        uniqueCheckins = true;
+        Database::setUniqueCheckins(true);
+    }
+    qint64 dbReady = startup.elapsed();
     MainWindow w;
     w.show();
+    cout << "Startup: application " << appReady << " ms, database " << dbReady - appReady << " ms (open "
+         << Database::getOpenMilliseconds() << " ms, " << (Database::createdSchema() ? "schema created" : "schema current")
+         << "), main window " << startup.elapsed() - dbReady << " ms" << endl;
 
 
     //Testing database
@@ -1,6 +1,17 @@
 #include "CameraImageWrapper.h"
 #include <QColor>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CIW_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 //values based on http://entropymine.com/imageworsener/grayscale/
 //round(0,2127*R)
 const byte CameraImageWrapper::R_TO_GREYSCALE[256] =  {
@@ -77,7 +88,7 @@ CameraImageWrapper::CameraImageWrapper(const QImage &sourceImage) : LuminanceSou
 
 CameraImageWrapper::CameraImageWrapper(CameraImageWrapper& otherInstance) : LuminanceSource(otherInstance.getWidth(), otherInstance.getHeight())
 {
-    imageBytesPerRow = otherInstance.getOriginalImage();
+    imageBytes = otherInstance.getOriginalImage();
     delegate = otherInstance.getDelegate();
 }
 
@@ -101,9 +112,47 @@ CameraImageWrapper *CameraImageWrapper::Factory(const QImage &sourceImage, int m
         return new CameraImageWrapper(sourceImage);
 }
 
-ArrayRef<ArrayRef<byte> > CameraImageWrapper::getOriginalImage()
+ArrayRef<byte> CameraImageWrapper::getOriginalImage()
 {
-    return imageBytesPerRow;
+    return imageBytes;
+}
+
+Ref<LuminanceSource> CameraImageWrapper::halfScale(const QImage& image)
+{
+    const int width = image.width();
+    const int halfWidth = width / 2;
+    const int halfHeight = image.height() / 2;
+
+    // two grey rows at a time are all the full resolution that is ever held
+    ArrayRef<byte> rows(2 * width);
+    ArrayRef<byte> half(halfWidth * halfHeight);
+    for (int j = 0; j < halfHeight; j++) {
+        scanLineToGray(image, 2 * j, &rows[0]);
+        scanLineToGray(image, 2 * j + 1, &rows[width]);
+        halveRows(&rows[0], &rows[width], &half[j * halfWidth], halfWidth);
+    }
+    return Ref<LuminanceSource>(new GreyscaleLuminanceSource(half, halfWidth, halfHeight, 0, 0, halfWidth, halfHeight));
+}
+
+Ref<LuminanceSource> CameraImageWrapper::halfScale(const LuminanceSource& source)
+{
+    const int width = source.getWidth();
+    const int halfWidth = width / 2;
+    const int halfHeight = source.getHeight() / 2;
+
+    int stride;
+    const byte* plane = source.getPlane(stride);
+    ArrayRef<byte> matrix;
+    if (!plane) {
+        matrix = source.getMatrix();
+        plane = &matrix[0];
+        stride = width;
+    }
+
+    ArrayRef<byte> half(halfWidth * halfHeight);
+    for (int j = 0; j < halfHeight; j++)
+        halveRows(plane + 2 * j * stride, plane + (2 * j + 1) * stride, &half[j * halfWidth], halfWidth);
+    return Ref<LuminanceSource>(new GreyscaleLuminanceSource(half, halfWidth, halfHeight, 0, 0, halfWidth, halfHeight));
 }
 
 ArrayRef<byte> CameraImageWrapper::getRow(int y, ArrayRef<byte> row) const
@@ -122,6 +171,14 @@ ArrayRef<byte> CameraImageWrapper::getMatrix() const
         return getMatrixP();
 }
 
+const byte* CameraImageWrapper::getPlane(int& stride) const
+{
+    if(delegate)
+        return delegate->getPlane(stride);
+    else
+        return NULL;
+}
+
 bool CameraImageWrapper::isCropSupported() const
 {
     if(delegate)
@@ -171,7 +228,8 @@ ArrayRef<byte> CameraImageWrapper::getRowP(int y, ArrayRef<byte> row) const
 
     Q_ASSERT(y >= 0 && y < getHeight());
 
-    return imageBytesPerRow[y];
+    memcpy(&row[0], &imageBytes[y * width], width);
+    return row;
 }
 
 ArrayRef<byte> CameraImageWrapper::getMatrixP() const
@@ -185,40 +243,142 @@ byte CameraImageWrapper::gray(unsigned int r, unsigned int g, unsigned int b)
     return R_TO_GREYSCALE[r] + G_TO_GREYSCALE[g] + B_TO_GREYSCALE[b];
 }
 
-void CameraImageWrapper::updateImageAsGrayscale(const QImage &origin)
+// The lookup tables above are reproduced exactly by per-channel fixed point:
+// TABLE[x] == (x * W + K) >> 13 for every x in 0..255 (checked exhaustively
+// against the tables). Each constant packs K in the high and W in the low 16 bits,
+// so _mm_madd_epi16 on a lane holding (1 << 16 | x) yields x * W + K.
+#define CIW_SHIFT 13
+#define CIW_R_MADD ((4165 << 16) | 1741)
+#define CIW_G_MADD ((4096 << 16) | 5859)
+#define CIW_B_MADD ((4063 << 16) | 592)
+
+#ifdef CIW_SSE2
+// four 0x??RRGGBB pixels in 32-bit lanes -> four grey values in 32-bit lanes
+static inline __m128i grayLanes(__m128i px)
 {
-    bool needsConvesionToGrayscale = origin.format() != QImage::Format_Grayscale8;
+    const __m128i low = _mm_set1_epi32(0xFF);
+    const __m128i one = _mm_set1_epi32(1 << 16);
+    __m128i b = _mm_or_si128(_mm_and_si128(px, low), one);
+    __m128i g = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(px, 8), low), one);
+    __m128i r = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(px, 16), low), one);
+    __m128i y = _mm_srli_epi32(_mm_madd_epi16(r, _mm_set1_epi32(CIW_R_MADD)), CIW_SHIFT);
+    y = _mm_add_epi32(y, _mm_srli_epi32(_mm_madd_epi16(g, _mm_set1_epi32(CIW_G_MADD)), CIW_SHIFT));
+    return _mm_add_epi32(y, _mm_srli_epi32(_mm_madd_epi16(b, _mm_set1_epi32(CIW_B_MADD)), CIW_SHIFT));
+}
 
-    QRgb pixel;
-    byte pixelGrayscale;
+static inline void storeGray16(byte* dst, __m128i y0, __m128i y1, __m128i y2, __m128i y3)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3)));
+}
+#endif
 
+#ifdef __AVX2__
+static inline __m256i grayLanes256(__m256i px)
+{
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    const __m256i one = _mm256_set1_epi32(1 << 16);
+    __m256i b = _mm256_or_si256(_mm256_and_si256(px, low), one);
+    __m256i g = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(px, 8), low), one);
+    __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(px, 16), low), one);
+    __m256i y = _mm256_srli_epi32(_mm256_madd_epi16(r, _mm256_set1_epi32(CIW_R_MADD)), CIW_SHIFT);
+    y = _mm256_add_epi32(y, _mm256_srli_epi32(_mm256_madd_epi16(g, _mm256_set1_epi32(CIW_G_MADD)), CIW_SHIFT));
+    return _mm256_add_epi32(y, _mm256_srli_epi32(_mm256_madd_epi16(b, _mm256_set1_epi32(CIW_B_MADD)), CIW_SHIFT));
+}
+#endif
+
+void CameraImageWrapper::rgb32ToGray(const uchar* src, byte* dst, int count)
+{
+    const QRgb* px = reinterpret_cast<const QRgb*>(src);
+    int i = 0;
+#ifdef __AVX2__
+    // the packs work per 128-bit half, the final permute restores pixel order
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (; i + 32 <= count; i += 32) {
+        __m256i y0 = grayLanes256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(px + i)));
+        __m256i y1 = grayLanes256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(px + i + 8)));
+        __m256i y2 = grayLanes256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(px + i + 16)));
+        __m256i y3 = grayLanes256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(px + i + 24)));
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(y0, y1), _mm256_packs_epi32(y2, y3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+#endif
+#ifdef CIW_SSE2
+    for (; i + 16 <= count; i += 16) {
+        storeGray16(dst + i,
+                    grayLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + i))),
+                    grayLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + i + 4))),
+                    grayLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + i + 8))),
+                    grayLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + i + 12))));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = R_TO_GREYSCALE[qRed(px[i])] + G_TO_GREYSCALE[qGreen(px[i])] + B_TO_GREYSCALE[qBlue(px[i])];
+}
+
+void CameraImageWrapper::rgb888ToGray(const uchar* src, byte* dst, int count)
+{
+    int i = 0;
+#ifdef __SSSE3__
+    // spread 4 packed R,G,B triplets into 0x00RRGGBB lanes; each load reads 16 bytes
+    // for the 12 it uses, so stop while a whole 16 pixel step stays inside the row
+    const __m128i spread = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    for (; i + 18 <= count; i += 16) {
+        const uchar* p = src + 3 * i;
+        storeGray16(dst + i,
+                    grayLanes(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), spread)),
+                    grayLanes(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), spread)),
+                    grayLanes(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 24)), spread)),
+                    grayLanes(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 36)), spread)));
+    }
+#endif
+    for (; i < count; i++) {
+        const uchar* p = src + 3 * i;
+        dst[i] = R_TO_GREYSCALE[p[0]] + G_TO_GREYSCALE[p[1]] + B_TO_GREYSCALE[p[2]];
+    }
+}
+
+void CameraImageWrapper::updateImageAsGrayscale(const QImage &origin)
+{
     const int width = getWidth();
     const int height = getHeight();
 
     imageBytes = ArrayRef<byte>(height*width);
-    imageBytesPerRow = ArrayRef<ArrayRef<byte>>(height);
     byte* m = &imageBytes[0];
 
-    for(int j=0; j<height; j++)
+    for (int j = 0; j < height; j++, m += width)
+        scanLineToGray(origin, j, m);
+}
+
+// The common camera formats are converted straight from the scan line.
+void CameraImageWrapper::scanLineToGray(const QImage &origin, int y, byte* dst)
+{
+    const int width = origin.width();
+    switch (origin.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        rgb32ToGray(origin.constScanLine(y), dst, width);
+        return;
+    case QImage::Format_RGB888:
+        rgb888ToGray(origin.constScanLine(y), dst, width);
+        return;
+    case QImage::Format_Grayscale8:
+        memcpy(dst, origin.constScanLine(y), width);
+        return;
+    default:
+        break;
+    }
+
+    for(int i=0; i<width; i++)
     {
-        ArrayRef<byte> line(width);
-        for(int i=0; i<width; i++)
-        {
-            pixel = origin.pixel(i,j);
-            if(needsConvesionToGrayscale)
-                pixelGrayscale = gray(qRed(pixel),qGreen(pixel),qBlue(pixel));
-            else
-                pixelGrayscale = pixel & 0xFF;
-            line[i] = pixelGrayscale;
-        }
-        imageBytesPerRow[j] = line;
-
-#if __cplusplus > 199711L
-        memcpy(m, line->values().data(), width);
-#else
-        memcpy(m, &line[0], width);
-#endif
-        m += width * sizeof(byte);
+        QRgb pixel = origin.pixel(i,y);
+        dst[i] = R_TO_GREYSCALE[qRed(pixel)] + G_TO_GREYSCALE[qGreen(pixel)] + B_TO_GREYSCALE[qBlue(pixel)];
     }
 }
 
+void CameraImageWrapper::halveRows(const byte* row0, const byte* row1, byte* dst, int halfWidth)
+{
+    for (int i = 0; i < halfWidth; i++)
+        dst[i] = (row0[2*i] + row0[2*i+1] + row1[2*i] + row1[2*i+1] + 2) >> 2;
+}
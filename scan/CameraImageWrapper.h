@@ -33,11 +33,18 @@ public:
 
     static CameraImageWrapper* Factory(const QImage& image, int maxWidth=-1, int maxHeight=-1, bool smoothTransformation=false);
     
-    ArrayRef<ArrayRef<byte> > getOriginalImage();
+    ArrayRef<byte> getOriginalImage();
     Ref<GreyscaleLuminanceSource> getDelegate() { return delegate; }
 
+    // The image at half resolution (2x2 box filter), converted to grey and filtered in one
+    // pass over its scan lines without building the full resolution grey image.
+    static Ref<LuminanceSource> halfScale(const QImage& image);
+    // The same for a grey source.
+    static Ref<LuminanceSource> halfScale(const LuminanceSource& source);
+
     ArrayRef<zxing::byte> getRow(int y, ArrayRef<zxing::byte> row) const;
     ArrayRef<zxing::byte> getMatrix() const;
+    const zxing::byte* getPlane(int& stride) const;
 
     bool isCropSupported() const;
     Ref<LuminanceSource> crop(int left, int top, int width, int height) const;
@@ -46,14 +53,21 @@ public:
     Ref<LuminanceSource> rotateCounterClockwise() const;
 
     inline byte gray(unsigned int r, unsigned int g, unsigned int b);
+
+    // convert count pixels of one scan line to grey, matching gray() exactly;
+    // SSE2/SSSE3/AVX2 paths are used when the compiler targets them
+    static void rgb32ToGray(const uchar* src, byte* dst, int count);
+    static void rgb888ToGray(const uchar* src, byte* dst, int count);
+    // 2x2 box filter of two rows into one row of halfWidth pixels
+    static void halveRows(const byte* row0, const byte* row1, byte* dst, int halfWidth);
   
 private:
     ArrayRef<zxing::byte> getRowP(int y, ArrayRef<zxing::byte> row) const;
     ArrayRef<zxing::byte> getMatrixP() const;
     void updateImageAsGrayscale(const QImage &origin);
+    static void scanLineToGray(const QImage &origin, int y, byte* dst);
 
     Ref<GreyscaleLuminanceSource> delegate;
-    ArrayRef<ArrayRef<byte>> imageBytesPerRow;
     ArrayRef<byte> imageBytes;
 
     static const byte B_TO_GREYSCALE[256];
@@ -1,13 +1,19 @@
 #include "QZXing.h"
 
 #include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/HybridBinarizer.h>
 #include <zxing/Binarizer.h>
 #include <zxing/BinaryBitmap.h>
 #include <zxing/MultiFormatReader.h>
 #include <zxing/DecodeHints.h>
+#include <zxing/common/StridedLuminanceSource.h>
+#include <zxing/common/Arena.h>
+#include <zxing/common/GridFusion.h>
+#include <zxing/qrcode/detector/FinderPattern.h>
 #include "CameraImageWrapper.h"
 #include "ImageHandler.h"
 #include <QTime>
+#include <QElapsedTimer>
 #include <QUrl>
 #include <QFileInfo>
 #include <zxing/qrcode/encoder/Encoder.h>
@@ -35,8 +41,13 @@
 
 using namespace zxing;
 
-QZXing::QZXing(QObject *parent) : QObject(parent), tryHarder_(false)
+QZXing::QZXing(QObject *parent) : QObject(parent), tryHarder_(false),
+    binarizer_(Binarizer_Global), preferredBinarizer_(Binarizer_Hybrid),
+    moduleSize_(0), fineModules_(false),
+    tracking_(false), trackingFullScanInterval_(10), frame_(0), frameGiven_(false), fullScanFrame_(0),
+    trackedFrame_(0), trackedWidth_(0), trackedHeight_(0), fusion_(new GridFusion())
 {
+    binarizationTime_[Binarizer_Global] = binarizationTime_[Binarizer_Hybrid] = -1;
     decoder = new MultiFormatReader();
     setDecoder(DecoderFormat_QR_CODE |
                DecoderFormat_DATA_MATRIX |
@@ -67,8 +78,13 @@ QZXing::~QZXing()
         delete decoder;
 }
 
-QZXing::QZXing(QZXing::DecoderFormat decodeHints, QObject *parent) : QObject(parent)
+QZXing::QZXing(QZXing::DecoderFormat decodeHints, QObject *parent) : QObject(parent), tryHarder_(false),
+    binarizer_(Binarizer_Global), preferredBinarizer_(Binarizer_Hybrid),
+    moduleSize_(0), fineModules_(false),
+    tracking_(false), trackingFullScanInterval_(10), frame_(0), frameGiven_(false), fullScanFrame_(0),
+    trackedFrame_(0), trackedWidth_(0), trackedHeight_(0), fusion_(new GridFusion())
 {
+    binarizationTime_[Binarizer_Global] = binarizationTime_[Binarizer_Hybrid] = -1;
     decoder = new MultiFormatReader();
     imageHandler = new ImageHandler();
 
@@ -108,6 +124,48 @@ bool QZXing::getTryHarder()
     return tryHarder_;
 }
 
+void QZXing::setTracking(bool tracking)
+{
+    if (tracking != tracking_) {
+        trackedRect_ = QRectF();
+        fusion_->reset();
+    }
+    tracking_ = tracking;
+}
+
+bool QZXing::getTracking() const
+{
+    return tracking_;
+}
+
+void QZXing::setTrackingFullScanInterval(int frames)
+{
+    trackingFullScanInterval_ = frames > 0 ? frames : 1;
+}
+
+void QZXing::setFrameNumber(quint64 frame)
+{
+    frame_ = frame;
+    frameGiven_ = true;
+}
+
+void QZXing::setBinarizer(QZXing::BinarizerStrategy strategy)
+{
+    binarizer_ = strategy;
+}
+
+QZXing::BinarizerStrategy QZXing::getBinarizer() const
+{
+    return binarizer_;
+}
+
+qint64 QZXing::getBinarizationTime(QZXing::BinarizerStrategy binarizer) const
+{
+    if (binarizer != Binarizer_Global && binarizer != Binarizer_Hybrid)
+        return -1;
+    return binarizationTime_[binarizer];
+}
+
 QString QZXing::decoderFormatToString(int fmt)
 {
     switch (fmt) {
@@ -310,7 +368,6 @@ QString QZXing::decodeImage(const QImage &image, int maxWidth, int maxHeight, bo
 {
     QTime t;
     t.start();
-    Ref<Result> res;
     emit decodingStarted();
 
     if(image.isNull())
@@ -320,74 +377,377 @@ QString QZXing::decodeImage(const QImage &image, int maxWidth, int maxHeight, bo
         return "";
     }
 
-    CameraImageWrapper *ciw = NULL;
+    int limitWidth = 999, limitHeight = 999;
+    if ((maxWidth > 0) || (maxHeight > 0)) {
+        limitWidth = maxWidth;
+        limitHeight = maxHeight;
+    } else {
+        smoothTransformation = true;
+    }
 
-    if ((maxWidth > 0) || (maxHeight > 0))
-        ciw = CameraImageWrapper::Factory(image, maxWidth, maxHeight, smoothTransformation);
+    bool needsScaling = (limitWidth != -1 && image.width() > limitWidth) ||
+                        (limitHeight != -1 && image.height() > limitHeight);
+
+    // Without explicit limits a large image is not smooth-scaled any more but decoded coarse
+    // to fine: first a box-filtered level of at most PYRAMID_TOP pixels a side, then the full
+    // resolution only if that level showed a symbol it could not read. Modules under
+    // MIN_COARSE_MODULE pixels at that level are too fine to sample there.
+    const bool pyramid = needsScaling && maxWidth <= 0 && maxHeight <= 0;
+    const int PYRAMID_TOP = 1280;
+    const float MIN_COARSE_MODULE = 2.0f;
+
+    Ref<LuminanceSource> source;
+#if QT_VERSION >= 0x050500
+    // grey images are read straight from the QImage buffer
+    if ((!needsScaling || pyramid) && image.format() == QImage::Format_Grayscale8)
+        source = new StridedLuminanceSource(image.constBits(), image.width(),
+                                            image.height(), image.bytesPerLine());
+#endif
+
+    if (!pyramid) {
+        if (source.empty())
+            source = CameraImageWrapper::Factory(image, limitWidth, limitHeight, smoothTransformation);
+        return decodeLuminanceSource(source, t);
+    }
+
+    int scale = 1;
+    while (qMax(image.width(), image.height()) / scale > PYRAMID_TOP)
+        scale *= 2;
+
+    // the last image's symbol was read at full resolution and is too fine for the coarse level,
+    // which would only find it again and escalate: start at full resolution while it stays
+    // that small, and go back to the coarse level once it grows or is gone
+    QString result;
+    if (scale == 1 || fineModules_) {
+        if (source.empty())
+            source = new CameraImageWrapper(image);
+        result = decodeLuminanceSource(source, t);
+    } else {
+        // the first level comes straight from the image; the full resolution grey image is only
+        // converted if it is needed
+        Ref<LuminanceSource> coarse = source.empty() ? CameraImageWrapper::halfScale(image)
+                                                     : CameraImageWrapper::halfScale(*source);
+        while (qMax(coarse->getWidth(), coarse->getHeight()) > PYRAMID_TOP)
+            coarse = CameraImageWrapper::halfScale(*coarse);
+        result = decodeLuminanceSource(coarse, t, &image);
+    }
+    fineModules_ = scale > 1 && moduleSize_ > 0 && moduleSize_ < MIN_COARSE_MODULE * scale;
+    return result;
+}
+
+QString QZXing::decodeGrayscale(const uchar *data, int width, int height, int bytesPerLine)
+{
+    QTime t;
+    t.start();
+    emit decodingStarted();
+
+    if (data == NULL || width <= 0 || height <= 0 || bytesPerLine < width)
+    {
+        emit decodingFinished(false);
+        processingTime = t.elapsed();
+        return "";
+    }
+
+    Ref<LuminanceSource> source(new StridedLuminanceSource(data, width, height, bytesPerLine));
+    return decodeLuminanceSource(source, t);
+}
+
+namespace {
+    /*!
+     * \brief A bitmap of the source binarized the given way, adding the time that took to
+     * times[kind]. The matrix is made up front so that its cost can be told apart from decoding;
+     * the readers then share it.
+     */
+    Ref<BinaryBitmap> binarize(Ref<LuminanceSource> source, QZXing::BinarizerStrategy kind, qint64 *times)
+    {
+        Ref<Binarizer> binz;
+        if (kind == QZXing::Binarizer_Hybrid)
+            binz = new HybridBinarizer(source);
+        else
+            binz = new GlobalHistogramBinarizer(source);
+        Ref<BinaryBitmap> bb( new BinaryBitmap(binz) );
+
+        QElapsedTimer timer;
+        timer.start();
+        try {
+            bb->getBlackMatrix();
+        } catch(zxing::Exception &/*e*/) {}
+        if (times[kind] < 0)
+            times[kind] = 0;
+        times[kind] += timer.nsecsElapsed() / 1000;
+        return bb;
+    }
+}
+
+/*!
+ * \brief Searches only the window around the tracked tag. Returns true and the decoded text
+ * when the tag is found there, and updates the tracked position.
+ */
+bool QZXing::decodeTrackedWindow(LuminanceSource *source, QString &string)
+{
+    const int width = source->getWidth();
+    const int height = source->getHeight();
+    if (trackedRect_.isEmpty() || width != trackedWidth_ || height != trackedHeight_)
+        return false;
+    // counted in frames, not decodes, so a decoder seeing every few frames still searches
+    // the whole frame as often as one seeing all of them
+    if (frame_ - fullScanFrame_ >= (quint64)trackingFullScanInterval_)
+        return false;
+
+    // the last position and the one predicted for this frame, however many frames later it is,
+    // with half a tag of margin all around (the rect joins finder pattern centres, so the symbol
+    // itself reaches a little beyond it)
+    const QRectF predicted = trackedRect_.translated(trackedMotion_ * qreal(frame_ - trackedFrame_));
+    const qreal margin = qMax<qreal>(16, qMax(trackedRect_.width(), trackedRect_.height()) / 2);
+    QRect window = trackedRect_.united(predicted)
+            .adjusted(-margin, -margin, margin, margin).toAlignedRect()
+            .intersected(QRect(0, 0, width, height));
+    // not worth it when the window is most of the frame
+    if (window.isEmpty() || window.width() * window.height() * 2 > width * height)
+        return false;
+
+    // crop without copying when the source exposes its plane
+    Ref<LuminanceSource> roi;
+    int stride;
+    const zxing::byte *plane = source->getPlane(stride);
+    if (plane)
+        roi = new StridedLuminanceSource(plane + window.y() * stride + window.x(),
+                                         window.width(), window.height(), stride);
+    else if (source->isCropSupported())
+        roi = source->crop(window.x(), window.y(), window.width(), window.height());
     else
-        ciw = CameraImageWrapper::Factory(image, 999, 999, true);
+        return false;
 
-    QString errorMessage = "Unknown";
+    Ref<BinaryBitmap> bb = binarize(roi, binarizer_ == Binarizer_Auto ? preferredBinarizer_ : binarizer_,
+                                    binarizationTime_);
+    DecodeHints hints((int)enabledDecoders);
+    hints.setGridFusion(fusion_);
+    Ref<Result> res;
     try {
-        Ref<LuminanceSource> imageRef(ciw);
-        Ref<GlobalHistogramBinarizer> binz( new GlobalHistogramBinarizer(imageRef) );
-        Ref<BinaryBitmap> bb( new BinaryBitmap(binz) );
+        res = decoder->tryDecode(bb, hints);
+    } catch(zxing::Exception &/*e*/) {}
+    if (!res)
+        return false;
 
-        DecodeHints hints((int)enabledDecoders);
+    QRectF rect;
+    bool hasRect = false;
+    try {
+        // back from window coordinates to normalized frame coordinates
+        const QRectF local = getTagRect(res->getResultPoints(), bb->getBlackMatrix()).normalized();
+        rect = QRectF((window.x() + local.x() * window.width()) / width,
+                      (window.y() + local.y() * window.height()) / height,
+                      local.width() * window.width() / width,
+                      local.height() * window.height() / height);
+        hasRect = !local.isEmpty();
+    } catch(zxing::Exception &/*e*/) {}
+
+    if (hasRect)
+        track(rect, width, height);
+    // reported the way getTagRect() builds its rects
+    const QRectF reported(QPointF(rect.left(), rect.bottom()), QPointF(rect.right(), rect.top()));
+    string = reportResult(res, hasRect ? &reported : NULL);
+    return true;
+}
+
+/*!
+ * \brief Remembers where the tag was found (rect normalized to a width x height source)
+ * and how far it moved per frame since the previous detection.
+ */
+void QZXing::track(const QRectF &rect, int width, int height)
+{
+    const QRectF pixels(rect.x() * width, rect.y() * height, rect.width() * width, rect.height() * height);
+    if (!trackedRect_.isEmpty() && width == trackedWidth_ && height == trackedHeight_ && frame_ > trackedFrame_)
+        trackedMotion_ = (pixels.center() - trackedRect_.center()) / qreal(frame_ - trackedFrame_);
+    else
+        trackedMotion_ = QPointF();
+    trackedRect_ = pixels;
+    trackedFrame_ = frame_;
+    trackedWidth_ = width;
+    trackedHeight_ = height;
+}
+
+QString QZXing::reportResult(Result *res, const QRectF *rect)
+{
+    QString string = QString(res->getText()->getText().c_str());
+    if (!string.isEmpty() && (string.length() > 0)) {
+        int fmt = res->getBarcodeFormat().value;
+        foundedFmt = decoderFormatToString(fmt);
+        charSet_ = QString::fromStdString(res->getCharSet());
+        if (!charSet_.isEmpty()) {
+            QTextCodec *codec = QTextCodec::codecForName(res->getCharSet().c_str());
+            if (codec)
+                string = codec->toUnicode(res->getText()->getText().c_str());
+        }
+
+        emit tagFound(string);
+        emit tagFoundAdvanced(string, foundedFmt, charSet_);
+        if (rect)
+            emit tagFoundAdvanced(string, foundedFmt, charSet_, *rect);
+    }
+    emit decodingFinished(true);
+    return string;
+}
+
+namespace {
+    /*!
+     * \brief Counts the finder pattern candidates reported while decoding, so a failed coarse
+     * pass can tell "nothing here" from "a symbol is here but could not be read at this scale".
+     */
+    class FinderCounter : public ResultPointCallback {
+    public:
+        FinderCounter() : count(0) {}
+        void foundPossibleResultPoint(ResultPoint const &) { count++; }
+        int count;
+    };
+
+    /*!
+     * \brief The decode attempts made on one source: plain, try harder, then the three other
+     * rotations when asked to. They all share the one bitmap, so the source is binarized once.
+     */
+    bool decodeAttempts(MultiFormatReader *decoder, Ref<BinaryBitmap> bb, DecodeHints hints,
+                        bool rotate, Ref<Result> &res, bool &rotated)
+    {
+        rotated = false;
 
-        bool hasSucceded = false;
+        // an empty result is the usual "no code in this frame"; only a symbol that was found
+        // but could not be read gets as far as an exception
         try {
-            res = decoder->decode(bb, hints);
-            hasSucceded = true;
-        }catch(zxing::Exception &e){}
+            res = decoder->tryDecode(bb, hints);
+            if (res) return true;
+        } catch(zxing::Exception &/*e*/) {}
 
-        if(!hasSucceded)
-        {
-            hints.setTryHarder(true);
+        hints.setTryHarder(true);
+        try {
+            res = decoder->tryDecode(bb, hints);
+            if (res) return true;
+        } catch(zxing::Exception &/*e*/) {}
+
+        if (rotate && bb->isRotateSupported()) {
+            Ref<BinaryBitmap> bbTmp = bb;
+            for (int i=0; i<3; i++) {
+                Ref<BinaryBitmap> rotatedImage(bbTmp->rotateCounterClockwise());
+                bbTmp = rotatedImage;
+                try {
+                    res = decoder->tryDecode(rotatedImage, hints);
+                    if (res) {
+                        rotated = true;
+                        return true;
+                    }
+                } catch(zxing::Exception &/*e*/) {}
+            }
+        }
+        return false;
+    }
 
-            try {
-                res = decoder->decode(bb, hints);
-                hasSucceded = true;
-            } catch(zxing::Exception &e) {}
-
-            if (tryHarder_ && bb->isRotateSupported()) {
-                Ref<BinaryBitmap> bbTmp = bb;
-
-                for (int i=0; (i<3 && !hasSucceded); i++) {
-                    Ref<BinaryBitmap> rotatedImage(bbTmp->rotateCounterClockwise());
-                    bbTmp = rotatedImage;
-
-                    try {
-                        res = decoder->decode(rotatedImage, hints);
-                        processingTime = t.elapsed();
-                        hasSucceded = true;
-                    } catch(zxing::Exception &e) {}
-                }
+    /*!
+     * \brief The mean module size the finder patterns of a QR result were found with, in pixels of
+     * the decoded bitmap; 0 for other formats.
+     */
+    float estimatedModuleSize(Ref<Result> res)
+    {
+        ArrayRef< Ref<ResultPoint> > points = res->getResultPoints();
+        float sum = 0;
+        int count = 0;
+        for (unsigned int i = 0; i < points->size(); ++i) {
+            ResultPoint *point = points[i];
+            const qrcode::FinderPattern *finder = dynamic_cast<const qrcode::FinderPattern *>(point);
+            if (finder) {
+                sum += finder->getEstimatedModuleSize();
+                count++;
             }
         }
+        return count ? sum / count : 0;
+    }
+}
 
-        if (hasSucceded) {
-            QString string = QString(res->getText()->getText().c_str());
-            if (!string.isEmpty() && (string.length() > 0)) {
-                int fmt = res->getBarcodeFormat().value;
-                foundedFmt = decoderFormatToString(fmt);
-                charSet_ = QString::fromStdString(res->getCharSet());
-                if (!charSet_.isEmpty()) {
-                    QTextCodec *codec = QTextCodec::codecForName(res->getCharSet().c_str());
-                    if (codec)
-                        string = codec->toUnicode(res->getText()->getText().c_str());
-                }
-
-                emit tagFound(string);
-                emit tagFoundAdvanced(string, foundedFmt, charSet_);
+QString QZXing::decodeLuminanceSource(LuminanceSource *source, const QTime &t, const QImage *fullImage)
+{
+    // the points, patterns, polynomials and sampled grids of this decode come from the thread's
+    // arena and are dropped together when the scope closes, after everything below is gone
+    zxing::Arena::Scope arenaScope;
+    Ref<LuminanceSource> imageRef(source);
+    Ref<Result> res;
+    moduleSize_ = 0;
+    QString errorMessage = "Unknown";
+    binarizationTime_[Binarizer_Global] = binarizationTime_[Binarizer_Hybrid] = -1;
+    try {
+        if (tracking_) {
+            const quint64 previousFrame = frame_;
+            if (!frameGiven_)
+                frame_++;
+            frameGiven_ = false;
+            // the vote is of a badge in front of the camera now, not of one this decoder saw
+            // long ago; every attempt below on this frame adds to the same vote
+            if (frame_ - previousFrame > (quint64)trackingFullScanInterval_)
+                fusion_->reset();
+            fusion_->nextFrame();
+            QString string;
+            if (decodeTrackedWindow(source, string)) {
+                processingTime = t.elapsed();
+                return string;
+            }
+            fullScanFrame_ = frame_;
+        }
 
-                try {
-                    const QRectF rect = getTagRect(res->getResultPoints(), binz->getBlackMatrix());
-                    emit tagFoundAdvanced(string, foundedFmt, charSet_, rect);
-                }catch(zxing::Exception &/*e*/){}
+        Ref<FinderCounter> finders( new FinderCounter() );
+        DecodeHints hints((int)enabledDecoders);
+        hints.setResultPointCallback(finders);
+        if (tracking_)
+            hints.setGridFusion(fusion_);
+
+        BinarizerStrategy kind = binarizer_ == Binarizer_Auto ? preferredBinarizer_ : binarizer_;
+        Ref<BinaryBitmap> bb = binarize(imageRef, kind, binarizationTime_);
+        bool rotated = false;
+        bool hasSucceded = decodeAttempts(decoder, bb, hints, tryHarder_, res, rotated);
+
+        // auto: finder patterns the first binarizer could not read get a go with the other one
+        if (!hasSucceded && binarizer_ == Binarizer_Auto && (finders->count >= 3 || tryHarder_)) {
+            kind = kind == Binarizer_Global ? Binarizer_Hybrid : Binarizer_Global;
+            bb = binarize(imageRef, kind, binarizationTime_);
+            hasSucceded = decodeAttempts(decoder, bb, hints, tryHarder_, res, rotated);
+        }
+
+        // coarse to fine: the full resolution image is only decoded when the coarse one showed
+        // finder patterns it could not read (or when asked to try harder)
+        bool escalated = false;
+        if (!hasSucceded && fullImage && (finders->count >= 3 || tryHarder_)) {
+            Ref<LuminanceSource> fullRef;
+#if QT_VERSION >= 0x050500
+            if (fullImage->format() == QImage::Format_Grayscale8)
+                fullRef = new StridedLuminanceSource(fullImage->constBits(), fullImage->width(),
+                                                     fullImage->height(), fullImage->bytesPerLine());
+            else
+#endif
+                fullRef = new CameraImageWrapper(*fullImage);
+            bb = binarize(fullRef, kind, binarizationTime_);
+            hasSucceded = decodeAttempts(decoder, bb, hints, tryHarder_, res, rotated);
+            escalated = true;
+        }
+
+        if (hasSucceded) {
+            if (binarizer_ == Binarizer_Auto)
+                preferredBinarizer_ = kind;
+            // in pixels of the full resolution image
+            moduleSize_ = estimatedModuleSize(res);
+            if (fullImage && !escalated)
+                moduleSize_ *= qreal(fullImage->width()) / imageRef->getWidth();
+            processingTime = t.elapsed();
+            QRectF rect;
+            bool hasRect = false;
+            try {
+                rect = getTagRect(res->getResultPoints(), bb->getBlackMatrix());
+                hasRect = true;
+            }catch(zxing::Exception &/*e*/){}
+
+            // result points of a rotated decode are not in frame coordinates, nor are those
+            // of the full resolution image
+            if (tracking_) {
+                if (hasRect && !rotated && !escalated && !rect.isEmpty())
+                    track(rect.normalized(), imageRef->getWidth(), imageRef->getHeight());
+                else
+                    trackedRect_ = QRectF();
             }
-            emit decodingFinished(true);
-            return string;
+            return reportResult(res, hasRect ? &rect : NULL);
         }
     }
     catch(zxing::Exception &e)
@@ -395,6 +755,7 @@ QString QZXing::decodeImage(const QImage &image, int maxWidth, int maxHeight, bo
         errorMessage = QString(e.what());
     }
 
+    trackedRect_ = QRectF();
     emit error(errorMessage);
     emit decodingFinished(false);
     processingTime = t.elapsed();
@@ -20,6 +20,8 @@
 #include "QZXing_global.h"
 #include <QObject>
 #include <QImage>
+#include <QRectF>
+#include <zxing/common/Counted.h>
 
 #if QT_VERSION >= 0x050000
     class QQmlEngine;
@@ -28,8 +30,12 @@
 // forward declaration
 namespace zxing {
 class MultiFormatReader;
+class LuminanceSource;
+class Result;
+class GridFusion;
 }
 class ImageHandler;
+class QTime;
 
 /**
   * A class containing a very very small subset of the ZXing library.
@@ -48,9 +54,12 @@ class
 
     Q_OBJECT
     Q_ENUMS(DecoderFormat)
+    Q_ENUMS(BinarizerStrategy)
     Q_PROPERTY(int processingTime READ getProcessTimeOfLastDecoding)
     Q_PROPERTY(uint enabledDecoders READ getEnabledFormats WRITE setDecoder NOTIFY enabledFormatsChanged)
     Q_PROPERTY(bool tryHarder READ getTryHarder WRITE setTryHarder)
+    Q_PROPERTY(bool tracking READ getTracking WRITE setTracking)
+    Q_PROPERTY(BinarizerStrategy binarizer READ getBinarizer WRITE setBinarizer)
 
 public:
     /*
@@ -78,6 +87,19 @@ public:
     } ;
     typedef unsigned int DecoderFormatType;
 
+    /**
+      * How an image is turned black and white before decoding.
+      * Global thresholds the whole image at one level, and fails under uneven lighting.
+      * Hybrid thresholds each 8x8 block against the blocks around it.
+      * Auto starts with whichever of the two last decoded something, and tries the other one
+      * when the first showed finder patterns it could not read.
+      */
+    enum BinarizerStrategy {
+        Binarizer_Global,
+        Binarizer_Hybrid,
+        Binarizer_Auto
+    };
+
     QZXing(QObject *parent = NULL);
     ~QZXing();
 
@@ -97,6 +119,34 @@ public:
 
     void setTryHarder(bool tryHarder);
     bool getTryHarder();
+
+    /**
+      * Tracking mode, meant for the frames of one video stream. After a detection, the next frames
+      * are first searched only in a window around the tag (and where its motion predicts it, for
+      * as many frames on as setFrameNumber() says), and the whole frame is searched on a miss or
+      * every fullScanInterval frames.
+      * A QR code that is found but cannot be read is also voted across the frames it appears
+      * in, so one too damaged for any single frame can still be read after a few; frames more
+      * than fullScanInterval apart do not vote together.
+      */
+    void setTracking(bool tracking);
+    bool getTracking() const;
+    void setTrackingFullScanInterval(int frames);
+    /**
+      * Numbers the next frame decoded in tracking mode. A decoder sharing a camera with other
+      * decoders sees only some of its frames, and the numbers tell it how far apart they are.
+      * They must increase; without them each tracked decode counts as the next frame.
+      */
+    void setFrameNumber(quint64 frame);
+
+    void setBinarizer(BinarizerStrategy strategy);
+    BinarizerStrategy getBinarizer() const;
+    /**
+      * Microseconds spent binarizing during the last decode with Binarizer_Global or
+      * Binarizer_Hybrid, or -1 when that binarizer was not used.
+      */
+    Q_INVOKABLE qint64 getBinarizationTime(BinarizerStrategy binarizer) const;
+
     static QString decoderFormatToString(int fmt);
     Q_INVOKABLE QString foundedFormat() const;
     Q_INVOKABLE QString charSet() const;
@@ -118,6 +168,13 @@ public slots:
       * The input image is read from a local image file.
       */
     QString decodeImageFromFile(const QString& imageFilePath, int maxWidth=-1, int maxHeight=-1, bool smoothTransformation = false);
+
+    /**
+      * The decoding function for 8-bit grey buffers such as the Y plane of a camera frame.
+      * The buffer is read in place, without copying or scaling, so it must stay valid
+      * until the call returns. bytesPerLine may be larger than width for padded rows.
+      */
+    QString decodeGrayscale(const uchar *data, int width, int height, int bytesPerLine);
     /**
      * The decoding function accessible from QML. (Suggested for Qt 4.x)
      */
@@ -183,6 +240,12 @@ signals:
     void error(QString msg);
 
 private:
+    QString decodeLuminanceSource(zxing::LuminanceSource *source, const QTime &t,
+                                  const QImage *fullImage = NULL);
+    bool decodeTrackedWindow(zxing::LuminanceSource *source, QString &string);
+    QString reportResult(zxing::Result *res, const QRectF *rect);
+    void track(const QRectF &rect, int width, int height);
+
     zxing::MultiFormatReader *decoder;
     DecoderFormatType enabledDecoders;
     ImageHandler *imageHandler;
@@ -190,6 +253,31 @@ private:
     QString foundedFmt;
     QString charSet_;
     bool tryHarder_;
+    BinarizerStrategy binarizer_;
+    /// the binarizer Auto starts with, and the time spent in each one during the last decode
+    BinarizerStrategy preferredBinarizer_;
+    qint64 binarizationTime_[2];
+    /// module size of the last symbol read, in pixels of the image given, and whether it was too
+    /// fine for the coarse level of decodeImage()'s pyramid
+    float moduleSize_;
+    bool fineModules_;
+
+    /// tracking state: last tag rect in pixels of a width x height source, the frame it was
+    /// found in, and how far it moved per frame
+    bool tracking_;
+    int trackingFullScanInterval_;
+    /// the number of the frame being decoded, whether setFrameNumber() gave it, and the number
+    /// of the last frame searched whole
+    quint64 frame_;
+    bool frameGiven_;
+    quint64 fullScanFrame_;
+    QRectF trackedRect_;
+    QPointF trackedMotion_;
+    quint64 trackedFrame_;
+    int trackedWidth_;
+    int trackedHeight_;
+    /// the module grids of the QR code seen in the recent frames
+    zxing::Ref<zxing::GridFusion> fusion_;
 
     /**
       * If true, the decoding operation will take place at a different thread.
@@ -56,11 +56,14 @@ HEADERS += $$PWD/QZXing_global.h \
     $$PWD/zxing/zxing/common/IllegalArgumentException.h \
     $$PWD/zxing/zxing/common/HybridBinarizer.h \
     $$PWD/zxing/zxing/common/GridSampler.h \
+    $$PWD/zxing/zxing/common/GridFusion.h \
     $$PWD/zxing/zxing/common/GreyscaleRotatedLuminanceSource.h \
     $$PWD/zxing/zxing/common/GreyscaleLuminanceSource.h \
+    $$PWD/zxing/zxing/common/StridedLuminanceSource.h \
     $$PWD/zxing/zxing/common/GlobalHistogramBinarizer.h \
     $$PWD/zxing/zxing/common/DetectorResult.h \
     $$PWD/zxing/zxing/common/DecoderResult.h \
+    $$PWD/zxing/zxing/common/Arena.h \
     $$PWD/zxing/zxing/common/Counted.h \
     $$PWD/zxing/zxing/common/CharacterSetECI.h \
     $$PWD/zxing/zxing/common/BitSource.h \
@@ -174,11 +177,14 @@ SOURCES += $$PWD/CameraImageWrapper.cpp \
     $$PWD/zxing/zxing/common/IllegalArgumentException.cpp \
     $$PWD/zxing/zxing/common/HybridBinarizer.cpp \
     $$PWD/zxing/zxing/common/GridSampler.cpp \
+    $$PWD/zxing/zxing/common/GridFusion.cpp \
     $$PWD/zxing/zxing/common/GreyscaleRotatedLuminanceSource.cpp \
     $$PWD/zxing/zxing/common/GreyscaleLuminanceSource.cpp \
+    $$PWD/zxing/zxing/common/StridedLuminanceSource.cpp \
     $$PWD/zxing/zxing/common/GlobalHistogramBinarizer.cpp \
     $$PWD/zxing/zxing/common/DetectorResult.cpp \
     $$PWD/zxing/zxing/common/DecoderResult.cpp \
+    $$PWD/zxing/zxing/common/Arena.cpp \
     $$PWD/zxing/zxing/common/CharacterSetECI.cpp \
     $$PWD/zxing/zxing/common/BitSource.cpp \
     $$PWD/zxing/zxing/common/BitMatrix.cpp \
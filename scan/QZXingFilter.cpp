@@ -1,6 +1,7 @@
 #include "QZXingFilter.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtConcurrent/QtConcurrent>
 
 namespace {
@@ -11,22 +12,86 @@ namespace {
                 117 * (b & 0xFF) +
                 0x200) >> 10;
     }
-    uchar yuvToGray(uchar Y, uchar U, uchar V)
+
+    /// Bytes per pixel of the first plane, or 0 when the format is not handled here.
+    int firstPlanePixelBytes(QVideoFrame::PixelFormat format)
+    {
+        switch (format) {
+        case QVideoFrame::Format_ARGB32:
+        case QVideoFrame::Format_ARGB32_Premultiplied:
+        case QVideoFrame::Format_RGB32:
+        case QVideoFrame::Format_BGRA32:
+        case QVideoFrame::Format_BGRA32_Premultiplied:
+        case QVideoFrame::Format_BGR32:
+            return 4;
+        case QVideoFrame::Format_BGR24:
+            return 3;
+        case QVideoFrame::Format_BGR565:
+        case QVideoFrame::Format_BGR555:
+            return 2;
+        case QVideoFrame::Format_YUV420P:
+        case QVideoFrame::Format_YV12:
+        case QVideoFrame::Format_NV12:
+        case QVideoFrame::Format_NV21:
+        case QVideoFrame::Format_Y8:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    bool isPlanarYuv(QVideoFrame::PixelFormat format)
     {
-        const int C = (int) Y - 16;
-        const int D = (int) U - 128;
-        const int E = (int) V - 128;
-        return gray(
-            qBound(0, (298 * C + 409 * E + 128) >> 8, 255),
-            qBound(0, (298 * C - 100 * D - 208 * E + 128) >> 8, 255),
-            qBound(0, (298 * C + 516 * D + 128) >> 8, 255)
-        );
+        return format == QVideoFrame::Format_YUV420P || format == QVideoFrame::Format_YV12 ||
+               format == QVideoFrame::Format_NV12 || format == QVideoFrame::Format_NV21;
     }
 }
 
+void SimpleVideoFrame::copyData(QVideoFrame & frame, const QRect & captureRect)
+{
+    frame.map(QAbstractVideoBuffer::ReadOnly);
+
+    QRect area(QPoint(0, 0), frame.size());
+    if (captureRect.x() >= 0 && captureRect.y() >= 0 && captureRect.isValid())
+        area = area.intersected(captureRect);
+    const int pixelBytes = firstPlanePixelBytes(frame.pixelFormat());
+
+    if (pixelBytes > 0 && !area.isEmpty()) {
+        /// Copy the capture rect row by row, packed.
+        const int rowBytes = area.width() * pixelBytes;
+        if (data.size() != rowBytes * area.height())
+            data.resize(rowBytes * area.height());
+        const int sourceStride = frame.bytesPerLine();
+        const uchar* src = frame.bits() + area.y() * sourceStride + area.x() * pixelBytes;
+        uchar* dst = reinterpret_cast<uchar*>(data.data());
+        for (int y = 0; y < area.height(); ++y) {
+            memcpy(dst, src, rowBytes);
+            dst += rowBytes;
+            src += sourceStride;
+        }
+        size = area.size();
+        stride = rowBytes;
+        pixelFormat = isPlanarYuv(frame.pixelFormat()) ? QVideoFrame::Format_Y8 : frame.pixelFormat();
+    } else {
+        /// Unknown layout: copy it all and let the decoding thread sort it out.
+        if (data.size() != frame.mappedBytes())
+            data.resize(frame.mappedBytes());
+        memcpy(data.data(), frame.bits(), frame.mappedBytes());
+        size = frame.size();
+        stride = frame.bytesPerLine();
+        pixelFormat = frame.pixelFormat();
+    }
+
+    frame.unmap();
+}
+
 QZXingFilter::QZXingFilter(QObject *parent)
     : QAbstractVideoFilter(parent)
     , decoding(false)
+    , decodingSlot(-1)
+    , readySlot(-1)
+    , processing(false)
+    , handoffTime(0)
 {
     /// Connecting signals to handlers that will send signals to QML
     connect(&decoder, &QZXing::decodingStarted,
@@ -82,36 +147,68 @@ QVideoFrame QZXingFilterRunnable::run(QVideoFrame * input, const QVideoSurfaceFo
     Q_UNUSED(surfaceFormat);
     Q_UNUSED(flags);
 
-    /// We dont want to decode every single frame we get, as this would be very costly
-    /// These checks are attempt on having only 1 frame being processed at a time.
     if(!input || !input->isValid())
     {
 //        qDebug() << "[QZXingFilterRunnable] Invalid Input ";
         return * input;
     }
-    if(filter->isDecoding())
-    {
-//        qDebug() << "------ decoder busy.";
-        return * input;
-    }
-    if(!filter->processThread.isFinished())
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /// Pick the slot that is neither being decoded nor waiting to be: the video thread owns it
+    /// until the frame is published below, so the copy needs no lock.
+    int slot;
     {
-//        qDebug() << "--[]-- decoder busy.";
-        return * input;
+        QMutexLocker lock(&filter->slotsMutex);
+        slot = 0;
+        while (slot == filter->decodingSlot || slot == filter->readySlot)
+            ++slot;
     }
 
-    filter->decoding = true;
+    /// Only the capture rect (and only the luminance of YUV frames) is copied.
+    filter->frames[slot].copyData(* input, filter->captureRect.toRect());
 
-    /// Copy the data we need to the filter.
-	/// TODO: Depending on the system / platform, this copy hangs up the UI for some seconds. Fix this.
-    filter->frame.copyData(* input);
+    bool startDecoding;
+    {
+        QMutexLocker lock(&filter->slotsMutex);
+        /// A newer frame replaces one that nobody picked up yet.
+        filter->readySlot = slot;
+        startDecoding = !filter->processing;
+        if (startDecoding) {
+            filter->processing = true;
+            filter->decoding = true;
+        }
+    }
 
     /// All processing that has to happen in another thread, as we are now in the UI thread.
-    filter->processThread = QtConcurrent::run(this, &QZXingFilterRunnable::processVideoFrameProbed, filter->frame, filter->captureRect.toRect());
+    if (startDecoding)
+        filter->processThread = QtConcurrent::run(this, &QZXingFilterRunnable::processFrames);
 
+    filter->handoffTime = int(timer.nsecsElapsed() / 1000);
     return * input;
 }
 
+void QZXingFilterRunnable::processFrames()
+{
+    for (;;) {
+        int slot;
+        {
+            QMutexLocker lock(&filter->slotsMutex);
+            filter->decodingSlot = -1;
+            if (filter->readySlot < 0) {
+                filter->processing = false;
+                break;
+            }
+            slot = filter->readySlot;
+            filter->readySlot = -1;
+            filter->decodingSlot = slot;
+        }
+        /// The frame is already cropped to the capture rect.
+        processVideoFrameProbed(filter->frames[slot], QRect());
+    }
+}
+
 static bool isRectValid(const QRect& rect)
 {
   return rect.x() >= 0 && rect.y() >= 0 && rect.isValid();
@@ -158,7 +255,7 @@ static QImage rgbDataToGrayscale(const uchar* data, const CaptureRect& captureRe
     uchar* pixelInit = image.bits();
     data += (captureRect.startY * captureRect.sourceWidth + captureRect.startX) * stride;
     for (int y = 1; y <= captureRect.targetHeight; ++y) {
-        uchar* pixel = pixelInit + (captureRect.targetHeight - y) * captureRect.targetWidth;
+        uchar* pixel = pixelInit + (captureRect.targetHeight - y) * image.bytesPerLine();
         for (int x = 0; x < captureRect.targetWidth; ++x) {
             uchar r = data[red];
             uchar g = data[green];
@@ -209,61 +306,30 @@ void QZXingFilterRunnable::processVideoFrameProbed(SimpleVideoFrame & videoFrame
 
     /// This is a forced "conversion", colors end up swapped.
     if(image.isNull() && videoFrame.pixelFormat == QVideoFrame::Format_BGR555)
-        image = QImage(data, width, height, QImage::Format_RGB555);
+        image = QImage(data, width, height, videoFrame.stride, QImage::Format_RGB555);
 
     /// This is a forced "conversion", colors end up swapped.
     if(image.isNull() && videoFrame.pixelFormat == QVideoFrame::Format_BGR565)
-        image = QImage(data, width, height, QImage::Format_RGB16);
-
-    //fix for issues #4 and #9
-    if(image.isNull() && videoFrame.pixelFormat == QVideoFrame::Format_YUV420P) {
-        image = QImage(captureRect.targetWidth, captureRect.targetHeight, QImage::Format_Grayscale8);
-        uchar* pixel = image.bits();
-        const int wh = width * height;
-        const int w_2 = width / 2;
-        const int wh_54 = wh * 5 / 4;
-
-        for (int y = captureRect.startY; y < captureRect.endY; y++) {
-            const int Y_offset = y * width;
-            const int y_2 = y / 2;
-            const int U_offset = y_2 * w_2 + wh;
-            const int V_offset = y_2 * w_2 + wh_54;
-            for (int x = captureRect.startX; x < captureRect.endX; x++) {
-                const int x_2 = x / 2;
-                const uchar Y = data[Y_offset + x];
-                const uchar U = data[U_offset + x_2];
-                const uchar V = data[V_offset + x_2];
-                *pixel = yuvToGray(Y, U, V);
-                ++pixel;
-            }
-        }
-    }
-
-    // nv12 format, encountered on macOS
-    if(image.isNull() && videoFrame.pixelFormat == QVideoFrame::Format_NV12) {
-        image = QImage(videoFrame.size, QImage::Format_Grayscale8);
-        uchar* pixel = image.bits();
-        const uchar* y_data = data;
-        const uchar* uv_data = data + (height * width);
-        for (int y = 0; y < height; y++) {
-            const int w_y_2 = width * int(y / 2); // floored half-y
-            for (int x = 0; x < width; x++) {
-                const uchar Y = *y_data;
-                const int uv_index = (w_y_2 + x / 2) * 2;
-                const uchar U = uv_data[uv_index];
-                const uchar V = uv_data[uv_index + 1];
-                y_data++;
-                *pixel = yuvToGray(Y, U, V);
-                ++pixel;
-            }
-        }
+        image = QImage(data, width, height, videoFrame.stride, QImage::Format_RGB16);
+
+    /// YUV420P (fix for issues #4 and #9) and NV12 (encountered on macOS) both start with
+    /// a full resolution Y plane, which is the grey image already: decode it in place.
+    /// Frames handed over by run() arrive as that plane alone, in Format_Y8.
+    if(image.isNull() && (videoFrame.pixelFormat == QVideoFrame::Format_YUV420P ||
+                          videoFrame.pixelFormat == QVideoFrame::Format_NV12 ||
+                          videoFrame.pixelFormat == QVideoFrame::Format_Y8)) {
+        const int stride = (videoFrame.stride > 0) ? videoFrame.stride : width;
+        if (filter != nullptr)
+            filter->decoder.decodeGrayscale(data + captureRect.startY * stride + captureRect.startX,
+                                            captureRect.targetWidth, captureRect.targetHeight, stride);
+        return;
     }
 
     /// TODO: Handle (create QImages from) YUV formats.
 
     if (image.isNull()) {
         QImage::Format imageFormat = QVideoFrame::imageFormatFromPixelFormat(videoFrame.pixelFormat);
-        image = QImage(data, width, height, imageFormat);
+        image = QImage(data, width, height, videoFrame.stride, imageFormat);
     }
 
     if(image.isNull())
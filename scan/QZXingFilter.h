@@ -21,6 +21,7 @@
 #include <QAbstractVideoFilter>
 #include <QDebug>
 #include <QFuture>
+#include <QMutex>
 #include <QZXing.h>
 
 ///
@@ -38,37 +39,19 @@ struct SimpleVideoFrame
 {
     QByteArray data;
     QSize size;
+    int stride;
     QVideoFrame::PixelFormat pixelFormat;
 
     SimpleVideoFrame()
         : size{0,0}
+        , stride{0}
         , pixelFormat{QVideoFrame::Format_Invalid}
     {}
 
-    SimpleVideoFrame(QVideoFrame & frame)
-    {
-        copyData(frame);
-    }
-
-    void copyData(QVideoFrame & frame)
-    {
-        frame.map(QAbstractVideoBuffer::ReadOnly);
-
-        /// Copy video frame bytes to this.data
-        /// This is made to try to get a better performance (less memory allocation, faster unmap)
-        /// Any other task is performed in a QFuture task, as we want to leave the UI thread asap
-        if(data.size() != frame.mappedBytes())
-        {
-            qDebug() << "needed to resize";
-            qDebug() << "size: " << data.size() << ", new size: " << frame.mappedBytes();
-            data.resize(frame.mappedBytes());
-        }
-        memcpy(data.data(), frame.bits(), frame.mappedBytes());
-        size = frame.size();
-        pixelFormat = frame.pixelFormat();
-
-        frame.unmap();
-    }
+    /// Copies what the decoder needs out of the frame: only the capture rect (the whole frame
+    /// if the rect is not valid) and, for planar YUV formats, only its Y plane, stored as Format_Y8.
+    /// The buffer is reused between frames, so this does not allocate in steady state.
+    void copyData(QVideoFrame & frame, const QRect & captureRect);
 };
 
 /// Video filter is the filter that has to be registered in C++, instantiated and attached in QML
@@ -80,6 +63,7 @@ class QZXingFilter : public QAbstractVideoFilter
         Q_PROPERTY(bool decoding READ isDecoding NOTIFY isDecodingChanged)
         Q_PROPERTY(QZXing* decoder READ getDecoder)
         Q_PROPERTY(QRectF captureRect MEMBER captureRect NOTIFY captureRectChanged)
+        Q_PROPERTY(int handoffTime READ getHandoffTime)
 
     signals:
         void isDecodingChanged();
@@ -96,15 +80,25 @@ class QZXingFilter : public QAbstractVideoFilter
         bool decoding;
         QRectF captureRect;
 
-        SimpleVideoFrame frame;
+        /// Triple buffer between the video thread and the decoding thread: one slot is being
+        /// decoded, one holds the newest frame waiting for it, and run() fills the third.
+        SimpleVideoFrame frames[3];
+        int decodingSlot;
+        int readySlot;
+        bool processing;
+        QMutex slotsMutex;
         QFuture<void> processThread;
 
+        /// Time run() spent on the video thread for the last frame, in microseconds.
+        int handoffTime;
+
     public:  /// Methods
         explicit QZXingFilter(QObject *parent = 0);
         virtual ~QZXingFilter();
 
         bool isDecoding() {return decoding; }
         QZXing* getDecoder() { return &decoder; }
+        int getHandoffTime() const { return handoffTime; }
 
         QVideoFilterRunnable * createFilterRunnable();
 };
@@ -120,6 +114,8 @@ class QZXingFilterRunnable : public QObject, public QVideoFilterRunnable
         /// This method is called whenever we get a new frame. It runs in the UI thread.
         QVideoFrame run(QVideoFrame * input, const QVideoSurfaceFormat &surfaceFormat, RunFlags flags);
         void processVideoFrameProbed(SimpleVideoFrame & videoFrame, const QRect& captureRect);
+        /// Decodes the newest ready frame until no new one has arrived. Runs in a worker thread.
+        void processFrames();
 
     private:
         QString decode(const QImage &image);
@@ -21,6 +21,7 @@
  */
 
 #include <zxing/Binarizer.h>
+#include <zxing/ReaderException.h>
 
 namespace zxing {
 	
@@ -30,6 +31,15 @@ namespace zxing {
 	Binarizer::~Binarizer() {
 	}
 	
+	Ref<BitArray> Binarizer::tryGetBlackRow(int y, Ref<BitArray> row) {
+		try {
+			return getBlackRow(y, row);
+		} catch (ReaderException const& re) {
+			(void)re;
+			return Ref<BitArray>();
+		}
+	}
+
 	Ref<LuminanceSource> Binarizer::getLuminanceSource() const {
 		return source_;
 	}
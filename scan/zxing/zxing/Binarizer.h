@@ -36,6 +36,8 @@ class Binarizer : public Counted {
   virtual ~Binarizer();
 
   virtual Ref<BitArray> getBlackRow(int y, Ref<BitArray> row) = 0;
+  // As getBlackRow(), but returns an empty Ref when the row has too little contrast
+  virtual Ref<BitArray> tryGetBlackRow(int y, Ref<BitArray> row);
   virtual Ref<BitMatrix> getBlackMatrix() = 0;
 
   Ref<LuminanceSource> getLuminanceSource() const ;
@@ -16,6 +16,8 @@
  */
 
 #include <zxing/BinaryBitmap.h>
+#include <zxing/NotFoundException.h>
+#include <algorithm>
 
 using zxing::Ref;
 using zxing::BitArray;
@@ -32,12 +34,59 @@ BinaryBitmap::BinaryBitmap(Ref<Binarizer> binarizer) : binarizer_(binarizer) {
 BinaryBitmap::~BinaryBitmap() {
 }
 
+// The black row y, worked out by the binarizer the first time it is asked for; an empty Ref when
+// the row has too little contrast.
+Ref<BitArray> BinaryBitmap::cachedBlackRow(int y) {
+    if (rows_.empty()) {
+        int height = getHeight();
+        rows_.resize(height);
+        rowsDone_.resize(height, false);
+    }
+    if (!rowsDone_[y]) {
+        rows_[y] = binarizer_->tryGetBlackRow(y, Ref<BitArray>());
+        rowsDone_[y] = true;
+    }
+    return rows_[y];
+}
+
 Ref<BitArray> BinaryBitmap::getBlackRow(int y, Ref<BitArray> row) {
-    return binarizer_->getBlackRow(y, row);
+    Ref<BitArray> blackRow = tryGetBlackRow(y, row);
+    if (blackRow.empty()) {
+        throw NotFoundException();
+    }
+    return blackRow;
+}
+
+// Readers reverse the rows they are given, so they get a copy of the cached row, in their own
+// row when it is big enough.
+Ref<BitArray> BinaryBitmap::tryGetBlackRow(int y, Ref<BitArray> row) {
+    Ref<BitArray> cached = cachedBlackRow(y);
+    if (cached.empty()) {
+        return cached;
+    }
+    if (row.empty() || row->getSize() < cached->getSize()) {
+        row = new BitArray(cached->getSize());
+    } else {
+        row->clear();
+    }
+    std::vector<BitArray::Word>& from = cached->getBitArray();
+    std::copy(from.begin(), from.end(), row->getBitArray().begin());
+    return row;
 }
 
 Ref<BitMatrix> BinaryBitmap::getBlackMatrix() {
-    return binarizer_->getBlackMatrix();
+    if (matrix_.empty()) {
+        if (!unrotated_.empty()) {
+            matrix_ = unrotated_->rotateCounterClockwise();
+            unrotated_ = Ref<BitMatrix>();
+        } else {
+            matrix_ = binarizer_->getBlackMatrix();
+        }
+        if (!rotated_.empty() && rotated_->matrix_.empty()) {
+            rotated_->unrotated_ = matrix_;
+        }
+    }
+    return matrix_;
 }
 
 int BinaryBitmap::getWidth() const {
@@ -64,8 +113,15 @@ bool BinaryBitmap::isRotateSupported() const {
     return getLuminanceSource()->isRotateSupported();
 }
 
+// The rotation is made once. Once this bitmap has its matrix, the rotated one takes its matrix
+// from this one, turned when first asked for, instead of binarizing the rotated luminance again;
+// its rows still come from the rotated source.
 Ref<BinaryBitmap> BinaryBitmap::rotateCounterClockwise() {
-    return Ref<BinaryBitmap> (new BinaryBitmap(binarizer_->createBinarizer(getLuminanceSource()->rotateCounterClockwise())));
+    if (rotated_.empty()) {
+        rotated_ = new BinaryBitmap(binarizer_->createBinarizer(getLuminanceSource()->rotateCounterClockwise()));
+        rotated_->unrotated_ = matrix_;
+    }
+    return rotated_;
 }
 
 Ref<zxing::BinaryBitmap> BinaryBitmap::rotateCounterClockwise45()
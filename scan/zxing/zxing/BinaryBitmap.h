@@ -24,18 +24,35 @@
 #include <zxing/common/BitMatrix.h>
 #include <zxing/common/BitArray.h>
 #include <zxing/Binarizer.h>
+#include <vector>
 
 namespace zxing {
 	
+	/*
+	 * One frame as the readers see it. The black matrix, each black row and the counter-clockwise
+	 * rotation are worked out once and then shared by every reader and every retry that decodes
+	 * this bitmap, so they must not modify what they are given.
+	 */
 	class BinaryBitmap : public Counted {
 	private:
 		Ref<Binarizer> binarizer_;
+		Ref<BitMatrix> matrix_;
+		// rows_[y] is the black row y once worked out; rowsDone_[y] tells an unread row from one
+		// with too little contrast
+		std::vector<Ref<BitArray> > rows_;
+		std::vector<bool> rowsDone_;
+		Ref<BinaryBitmap> rotated_;
+		// on a rotated bitmap, the matrix of the bitmap it was turned from, until matrix_ is made
+		Ref<BitMatrix> unrotated_;
 		
+		Ref<BitArray> cachedBlackRow(int y);
+
 	public:
 		BinaryBitmap(Ref<Binarizer> binarizer);
 		virtual ~BinaryBitmap();
 		
 		Ref<BitArray> getBlackRow(int y, Ref<BitArray> row);
+		Ref<BitArray> tryGetBlackRow(int y, Ref<BitArray> row);
 		Ref<BitMatrix> getBlackMatrix();
 		
 		Ref<LuminanceSource> getLuminanceSource() const;
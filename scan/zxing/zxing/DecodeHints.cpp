@@ -24,6 +24,7 @@
 
 using zxing::Ref;
 using zxing::ResultPointCallback;
+using zxing::GridFusion;
 using zxing::DecodeHintType;
 using zxing::DecodeHints;
 
@@ -136,11 +137,22 @@ Ref<ResultPointCallback> DecodeHints::getResultPointCallback() const {
   return callback;
 }
 
+void DecodeHints::setGridFusion(Ref<GridFusion> const& _fusion) {
+  fusion = _fusion;
+}
+
+Ref<GridFusion> DecodeHints::getGridFusion() const {
+  return fusion;
+}
+
 zxing::DecodeHints zxing::operator | (DecodeHints const& l, DecodeHints const& r) {
   DecodeHints result (l);
   result.hints |= r.hints;
   if (!result.callback) {
     result.callback = r.callback;
   }
+  if (!result.fusion) {
+    result.fusion = r.fusion;
+  }
   return result;
 }
@@ -22,6 +22,7 @@
 
 #include <zxing/BarcodeFormat.h>
 #include <zxing/ResultPointCallback.h>
+#include <zxing/common/GridFusion.h>
 
 namespace zxing {
 
@@ -33,6 +34,7 @@ class DecodeHints {
  private:
   DecodeHintType hints;
   Ref<ResultPointCallback> callback;
+  Ref<GridFusion> fusion;
 
  public:
   static const DecodeHintType AZTEC_HINT = 1 << BarcodeFormat::AZTEC;
@@ -73,10 +75,16 @@ class DecodeHints {
   void clear() {hints=0;}
   void setTryHarder(bool toset);
   bool getTryHarder() const;
+  DecodeHintType getHintMask() const {return hints;}
 
   void setResultPointCallback(Ref<ResultPointCallback> const&);
   Ref<ResultPointCallback> getResultPointCallback() const;
 
+  // For consecutive video frames: the QR reader adds each grid it samples and, when a frame
+  // fails to decode on its own, tries the grid voted from the frames before it too
+  void setGridFusion(Ref<GridFusion> const&);
+  Ref<GridFusion> getGridFusion() const;
+
   friend DecodeHints operator | (DecodeHints const&, DecodeHints const&);
 };
 
@@ -30,6 +30,10 @@ LuminanceSource::LuminanceSource(int width_, int height_) :width(width_), height
 
 LuminanceSource::~LuminanceSource() {}
 
+const zxing::byte* LuminanceSource::getPlane(int&) const {
+  return NULL;
+}
+
 bool LuminanceSource::isCropSupported() const {
   return false;
 }
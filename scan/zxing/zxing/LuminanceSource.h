@@ -43,6 +43,11 @@ class LuminanceSource : public Counted {
   virtual ArrayRef<byte> getRow(int y, ArrayRef<byte> row) const = 0;
   virtual ArrayRef<byte> getMatrix() const = 0;
 
+  // Read-only access to the luminance plane without copying: row y starts at
+  // plane + y * stride. Returns NULL when the source has no such plane, in
+  // which case callers fall back to getRow()/getMatrix().
+  virtual const byte* getPlane(int& stride) const;
+
   virtual bool isCropSupported() const;
   virtual Ref<LuminanceSource> crop(int left, int top, int width, int height) const;
 
@@ -24,6 +24,7 @@
 #include <zxing/oned/MultiFormatUPCEANReader.h>
 #include <zxing/oned/MultiFormatOneDReader.h>
 #include <zxing/ReaderException.h>
+#include <zxing/common/Arena.h>
 
 using zxing::Ref;
 using zxing::Result;
@@ -32,30 +33,56 @@ using zxing::MultiFormatReader;
 // VC++
 using zxing::DecodeHints;
 using zxing::BinaryBitmap;
+using zxing::DecodeHintType;
+using zxing::Reader;
+using zxing::Arena;
 
-MultiFormatReader::MultiFormatReader() {}
+MultiFormatReader::MultiFormatReader() : readers_(0) {}
   
 Ref<Result> MultiFormatReader::decode(Ref<BinaryBitmap> image) {
   setHints(DecodeHints::DEFAULT_HINT);
-  return decodeInternal(image);
+  return found(decodeInternal(image));
 }
 
 Ref<Result> MultiFormatReader::decode(Ref<BinaryBitmap> image, DecodeHints hints) {
+  setHints(hints);
+  return found(decodeInternal(image));
+}
+
+Ref<Result> MultiFormatReader::tryDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
   setHints(hints);
   return decodeInternal(image);
 }
 
 Ref<Result> MultiFormatReader::decodeWithState(Ref<BinaryBitmap> image) {
   // Make sure to set up the default state so we don't crash
-  if (readers_.size() == 0) {
+  if (!readers_) {
     setHints(DecodeHints::DEFAULT_HINT);
   }
-  return decodeInternal(image);
+  return found(decodeInternal(image));
+}
+
+Ref<Result> MultiFormatReader::found(Ref<Result> result) {
+  if (result == 0) {
+    throw ReaderException("No code detected");
+  }
+  return result;
 }
 
 void MultiFormatReader::setHints(DecodeHints hints) {
   hints_ = hints;
-  readers_.clear();
+  std::map<DecodeHintType, std::vector<Ref<Reader> > >::iterator cached = readerSets_.find(hints.getHintMask());
+  if (cached == readerSets_.end()) {
+    // the readers are kept for later decodes, so they must not pin the arena chunk of this one
+    Arena::Suspend heap;
+    std::vector<Ref<Reader> > readers;
+    createReaders(hints, readers);
+    cached = readerSets_.insert(std::make_pair(hints.getHintMask(), readers)).first;
+  }
+  readers_ = &cached->second;
+}
+
+void MultiFormatReader::createReaders(DecodeHints hints, std::vector<Ref<Reader> >& readers) {
   bool tryHarder = hints.getTryHarder();
 
   bool addOneDReader = hints.containsFormat(BarcodeFormat::UPC_E) ||
@@ -71,19 +98,19 @@ void MultiFormatReader::setHints(DecodeHints hints) {
     hints.containsFormat(BarcodeFormat::RSS_14) ||
     hints.containsFormat(BarcodeFormat::RSS_EXPANDED);
   if (addOneDReader && !tryHarder) {
-    readers_.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
+    readers.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
   }
   if (hints.containsFormat(BarcodeFormat::QR_CODE)) {
-    readers_.push_back(Ref<Reader>(new zxing::qrcode::QRCodeReader()));
+    readers.push_back(Ref<Reader>(new zxing::qrcode::QRCodeReader()));
   }
   if (hints.containsFormat(BarcodeFormat::DATA_MATRIX)) {
-    readers_.push_back(Ref<Reader>(new zxing::datamatrix::DataMatrixReader()));
+    readers.push_back(Ref<Reader>(new zxing::datamatrix::DataMatrixReader()));
   }
   if (hints.containsFormat(BarcodeFormat::AZTEC)) {
-    readers_.push_back(Ref<Reader>(new zxing::aztec::AztecReader()));
+    readers.push_back(Ref<Reader>(new zxing::aztec::AztecReader()));
   }
   if (hints.containsFormat(BarcodeFormat::PDF_417)) {
-    readers_.push_back(Ref<Reader>(new zxing::pdf417::PDF417Reader()));
+    readers.push_back(Ref<Reader>(new zxing::pdf417::PDF417Reader()));
   }
   /*
   if (hints.contains(BarcodeFormat.MAXICODE)) {
@@ -91,34 +118,37 @@ void MultiFormatReader::setHints(DecodeHints hints) {
   }
   */
   if (addOneDReader && tryHarder) {
-    readers_.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
+    readers.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
   }
-  if (readers_.size() == 0) {
+  if (readers.size() == 0) {
     if (!tryHarder) {
-      readers_.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
+      readers.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
     }
-    readers_.push_back(Ref<Reader>(new zxing::qrcode::QRCodeReader()));
-    readers_.push_back(Ref<Reader>(new zxing::datamatrix::DataMatrixReader()));
-    readers_.push_back(Ref<Reader>(new zxing::aztec::AztecReader()));
-    readers_.push_back(Ref<Reader>(new zxing::pdf417::PDF417Reader()));
+    readers.push_back(Ref<Reader>(new zxing::qrcode::QRCodeReader()));
+    readers.push_back(Ref<Reader>(new zxing::datamatrix::DataMatrixReader()));
+    readers.push_back(Ref<Reader>(new zxing::aztec::AztecReader()));
+    readers.push_back(Ref<Reader>(new zxing::pdf417::PDF417Reader()));
     // readers.add(new MaxiCodeReader());
 
     if (tryHarder) {
-      readers_.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
+      readers.push_back(Ref<Reader>(new zxing::oned::MultiFormatOneDReader(hints)));
     }
   }
 }
 
 Ref<Result> MultiFormatReader::decodeInternal(Ref<BinaryBitmap> image) {
-  for (unsigned int i = 0; i < readers_.size(); i++) {
+  for (unsigned int i = 0; i < readers_->size(); i++) {
     try {
-      return readers_[i]->decode(image, hints_);
+      Ref<Result> result = (*readers_)[i]->tryDecode(image, hints_);
+      if (result != 0) {
+        return result;
+      }
     } catch (ReaderException const& re) {
       (void)re;
       // continue
     }
   }
-  throw ReaderException("No code detected");
+  return Ref<Result>();
 }
   
 MultiFormatReader::~MultiFormatReader() {}
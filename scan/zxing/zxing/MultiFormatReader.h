@@ -25,20 +25,33 @@
 #include <zxing/common/BitArray.h>
 #include <zxing/Result.h>
 #include <zxing/DecodeHints.h>
+#include <map>
 
 namespace zxing {
   class MultiFormatReader : public Reader {
   private:
+    // returns an empty Ref when no reader finds a symbol
     Ref<Result> decodeInternal(Ref<BinaryBitmap> image);
-  
-    std::vector<Ref<Reader> > readers_;
+    static Ref<Result> found(Ref<Result> result);
+    static void createReaders(DecodeHints hints, std::vector<Ref<Reader> >& readers);
+
+    std::vector<Ref<Reader> >* readers_;
     DecodeHints hints_;
+    // reader sets already built for a hint mask; callers alternate between a few masks
+    // (e.g. normal and try-harder), so each set is only constructed once per instance
+    std::map<DecodeHintType, std::vector<Ref<Reader> > > readerSets_;
+
+    // readers_ points into readerSets_, so instances must not be copied
+    MultiFormatReader(const MultiFormatReader&);
+    MultiFormatReader& operator=(const MultiFormatReader&);
 
   public:
     MultiFormatReader();
     
     Ref<Result> decode(Ref<BinaryBitmap> image);
     Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints);
+    // As decode(), but returns an empty Ref when no reader finds a symbol
+    Ref<Result> tryDecode(Ref<BinaryBitmap> image, DecodeHints hints);
     Ref<Result> decodeWithState(Ref<BinaryBitmap> image);
     void setHints(DecodeHints hints);
     ~MultiFormatReader();
@@ -19,6 +19,7 @@
  */
 
 #include <zxing/Reader.h>
+#include <zxing/ReaderException.h>
 
 namespace zxing {
 
@@ -28,4 +29,13 @@ Ref<Result> Reader::decode(Ref<BinaryBitmap> image) {
   return decode(image, DecodeHints::DEFAULT_HINT);
 }
 
+Ref<Result> Reader::tryDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
+  try {
+    return decode(image, hints);
+  } catch (ReaderException const& re) {
+    (void)re;
+    return Ref<Result>();
+  }
+}
+
 }
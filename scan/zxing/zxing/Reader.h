@@ -32,6 +32,9 @@ namespace zxing {
   public:
    virtual Ref<Result> decode(Ref<BinaryBitmap> image);
    virtual Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints) = 0;
+   // Returns an empty Ref when no symbol is found. Readers whose common "not found" outcome
+   // can be reported without throwing override this; the default catches ReaderException.
+   virtual Ref<Result> tryDecode(Ref<BinaryBitmap> image, DecodeHints hints);
    virtual ~Reader();
 };
 
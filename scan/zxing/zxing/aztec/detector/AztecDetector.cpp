@@ -168,7 +168,7 @@ Detector::getMatrixCornerPoints(std::vector<Ref<Point> > bullEyeCornerPoints) {
     throw ReaderException("matrix extends over image bounds");
   }
   Array< Ref<ResultPoint> >* array = new Array< Ref<ResultPoint> >();
-  vector< Ref<ResultPoint> >& returnValue (array->values());
+  Array< Ref<ResultPoint> >::Vector& returnValue (array->values());
   returnValue.push_back(Ref<ResultPoint>(new ResultPoint(float(targetax), float(targetay))));
   returnValue.push_back(Ref<ResultPoint>(new ResultPoint(float(targetbx), float(targetby))));
   returnValue.push_back(Ref<ResultPoint>(new ResultPoint(float(targetcx), float(targetcy))));
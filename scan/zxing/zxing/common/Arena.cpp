@@ -0,0 +1,163 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  Copyright 2010 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/Arena.h>
+#include <atomic>
+#include <cstdlib>
+
+using zxing::Arena;
+
+namespace {
+  // every block starts with a header naming the chunk it was carved from, or 0 for the heap;
+  // it is also the alignment of every block
+  const size_t HEADER = 16;
+  // a QR decode takes around 8 KiB of this
+  const size_t CHUNK_SIZE = 64 * 1024;
+  // anything bigger, e.g. a frame or its binarized matrix, goes to the heap
+  const size_t MAX_BLOCK = CHUNK_SIZE / 4;
+
+  size_t roundUp(size_t size) {
+    return (size + HEADER - 1) & ~(HEADER - 1);
+  }
+
+  // the arena of the thread, while a scope is open on it
+  thread_local Arena* active = 0;
+  thread_local Arena::Counts counted = { 0, 0, 0 };
+}
+
+struct Arena::Chunk {
+  // blocks still in use, plus one while the arena allocates from the chunk
+  std::atomic<int> live;
+  char* next;
+  char* end;
+
+  char* begin() {
+    return reinterpret_cast<char*>(this) + roundUp(sizeof(Chunk));
+  }
+};
+
+Arena::Arena() : chunk_(0), depth_(0) {
+}
+
+Arena::~Arena() {
+  if (chunk_) {
+    release(chunk_);
+  }
+}
+
+Arena& Arena::local() {
+  static thread_local Arena arena;
+  return arena;
+}
+
+Arena::Scope::Scope() {
+  Arena& arena = local();
+  if (arena.depth_++ == 0) {
+    active = &arena;
+  }
+}
+
+Arena::Scope::~Scope() {
+  Arena& arena = local();
+  if (--arena.depth_ == 0) {
+    active = 0;
+    arena.rewind();
+  }
+}
+
+Arena::Suspend::Suspend() : arena_(active) {
+  active = 0;
+}
+
+Arena::Suspend::~Suspend() {
+  active = arena_;
+}
+
+Arena::Counts Arena::counts() {
+  return counted;
+}
+
+void* Arena::allocate(size_t size) {
+  const size_t bytes = HEADER + roundUp(size);
+  Arena* arena = active;
+  if (arena && bytes <= MAX_BLOCK) {
+    counted.arenaBlocks++;
+    return arena->bump(bytes);
+  }
+  counted.heapBlocks++;
+  char* block = static_cast<char*>(malloc(bytes));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<Chunk**>(block) = 0;
+  return block + HEADER;
+}
+
+void Arena::deallocate(void* p) {
+  if (!p) {
+    return;
+  }
+  char* block = static_cast<char*>(p) - HEADER;
+  Chunk* chunk = *reinterpret_cast<Chunk**>(block);
+  if (chunk) {
+    release(chunk);
+  } else {
+    free(block);
+  }
+}
+
+void* Arena::bump(size_t bytes) {
+  if (!chunk_ || size_t(chunk_->end - chunk_->next) < bytes) {
+    Chunk* chunk = static_cast<Chunk*>(malloc(CHUNK_SIZE));
+    if (!chunk) {
+      throw std::bad_alloc();
+    }
+    counted.chunks++;
+    new (&chunk->live) std::atomic<int>(1);
+    chunk->next = chunk->begin();
+    chunk->end = reinterpret_cast<char*>(chunk) + CHUNK_SIZE;
+    // the full chunk lives on until the blocks still in it are freed
+    if (chunk_) {
+      release(chunk_);
+    }
+    chunk_ = chunk;
+  }
+  char* block = chunk_->next;
+  chunk_->next += bytes;
+  chunk_->live.fetch_add(1, std::memory_order_relaxed);
+  *reinterpret_cast<Chunk**>(block) = chunk_;
+  return block + HEADER;
+}
+
+void Arena::rewind() {
+  if (!chunk_) {
+    return;
+  }
+  // only the arena's own hold left: nothing made in the scope outlived it
+  if (chunk_->live.load(std::memory_order_acquire) == 1) {
+    chunk_->next = chunk_->begin();
+  } else {
+    release(chunk_);
+    chunk_ = 0;
+  }
+}
+
+void Arena::release(Chunk* chunk) {
+  if (chunk->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    free(chunk);
+  }
+}
@@ -0,0 +1,141 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+/*
+ *  Copyright 2010 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace zxing {
+
+/* Bump allocator for the short-lived objects of a decode.
+   While an Arena::Scope is open on a thread, Counted objects, Array contents and small BitMatrix
+   storage made on that thread are carved out of the thread's arena instead of the heap, and
+   freeing them costs nothing. When the outermost scope closes the arena starts over at the
+   beginning of its chunk, unless something made inside the scope is still referenced; that chunk
+   is then left to those objects, freed with the last of them (on any thread), and the arena
+   takes a new one. Outside a scope allocate() and deallocate() fall through to the heap. */
+class Arena {
+public:
+  class Scope {
+  public:
+    Scope();
+    ~Scope();
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+  };
+
+  /* While one is alive, allocations on its thread come from the heap even inside a scope; for
+     objects that are kept across decodes, such as cached readers. */
+  class Suspend {
+  public:
+    Suspend();
+    ~Suspend();
+  private:
+    Suspend(const Suspend&);
+    Suspend& operator=(const Suspend&);
+    Arena* arena_;
+  };
+
+  /* allocations made by allocate() on one thread since it started */
+  struct Counts {
+    unsigned long heapBlocks;
+    unsigned long arenaBlocks;
+    unsigned long chunks;
+  };
+  static Counts counts();
+
+  static void* allocate(size_t size);
+  static void deallocate(void* p);
+
+private:
+  struct Chunk;
+
+  Arena();
+  ~Arena();
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+  static Arena& local();
+  void* bump(size_t bytes);
+  void rewind();
+  static void release(Chunk* chunk);
+
+  Chunk* chunk_;
+  int depth_;
+};
+
+/* std::vector allocator drawing from the arena */
+template<typename T> class ArenaAllocator {
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  template<typename U> struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  ArenaAllocator() {
+  }
+  template<typename U> ArenaAllocator(const ArenaAllocator<U>&) {
+  }
+
+  pointer allocate(size_type n, const void* = 0) {
+    return static_cast<pointer>(Arena::allocate(n * sizeof(T)));
+  }
+  void deallocate(pointer p, size_type) {
+    Arena::deallocate(p);
+  }
+  size_type max_size() const {
+    return size_type(-1) / sizeof(T);
+  }
+  void construct(pointer p, const T& value) {
+    ::new (static_cast<void*>(p)) T(value);
+  }
+  void destroy(pointer p) {
+    p->~T();
+  }
+  pointer address(reference r) const {
+    return &r;
+  }
+  const_pointer address(const_reference r) const {
+    return &r;
+  }
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return true;
+}
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return false;
+}
+
+/* scratch vector of a decode */
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+}
+
+#endif // __ARENA_H__
@@ -21,8 +21,10 @@
  * limitations under the License.
  */
 
+#include <type_traits>
 #include <vector>
 
+#include <zxing/common/Arena.h>
 #include <zxing/common/Counted.h>
 
 namespace zxing {
@@ -30,7 +32,12 @@ namespace zxing {
 template<typename T> class Array : public Counted {
 protected:
 public:
-  std::vector<T> values_;
+  // numbers and pointers come from the arena; types with copy constructors of their own (Refs,
+  // BigIntegers) from the heap, as the allocator's inlined copies of those trip -Warray-bounds
+  // and their arrays are few and short anyway
+  typedef typename std::conditional<std::is_scalar<T>::value,
+                                    ArenaVector<T>, std::vector<T> >::type Vector;
+  Vector values_;
   Array() {}
   Array(int n) :
       Counted(), values_(n, T()) {
@@ -45,7 +52,7 @@ public:
       Counted(), values_(n, v) {
   }
   Array(std::vector<T> &v) :
-      Counted(), values_(v) {
+      Counted(), values_(v.begin(), v.end()) {
   }
   Array(Array<T> &other) :
       Counted(), values_(other.values_) {
@@ -60,7 +67,7 @@ public:
     return *this;
   }
   Array<T>& operator=(const std::vector<T> &array) {
-    values_ = array;
+    values_.assign(array.begin(), array.end());
     return *this;
   }
   T const& operator[](int i) const {
@@ -75,10 +82,10 @@ public:
   bool empty() const {
     return values_.size() == 0;
   }
-  std::vector<T> const& values() const {
+  Vector const& values() const {
     return values_;
   }
-  std::vector<T>& values() {
+  Vector& values() {
     return values_;
   }
   void push_back(T value) {
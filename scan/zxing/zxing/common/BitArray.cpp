@@ -31,13 +31,13 @@ using zxing::Ref;
 namespace zxing {
 
 int BitArray::makeArraySize(int size) {
-    return (size + 31) / 32;
+    return (size + bitsMask) >> logBits;
 }
 
 BitArray::BitArray(): size(0), bits(1) {}
 
 BitArray::BitArray(int size_)
-    : size(size_), bits(makeArraySize(size)) {}
+    : size(size_), bits(makeArraySize(size_)) {}
 
 BitArray::~BitArray() {
 }
@@ -51,15 +51,12 @@ int BitArray::getSizeInBytes() const
     return (size + 7)/8;
 }
 
-void BitArray::setBulk(int i, int newBits) {
-    bits[i / 32] = newBits;
+void BitArray::setBulk(int i, Word newBits) {
+    bits[i >> logBits] = newBits;
 }
 
 void BitArray::clear() {
-    int max = bits->size();
-    for (int i = 0; i < max; i++) {
-        bits[i] = 0;
-    }
+    memset(&bits[0], 0, bits.size() * sizeof(Word));
 }
 
 bool BitArray::isRange(int start, int end, bool value) {
@@ -70,20 +67,13 @@ bool BitArray::isRange(int start, int end, bool value) {
         return true; // empty range matches
     }
     end--; // will be easier to treat this as the last actually set bit -- inclusive
-    int firstInt = start / 32;
-    int lastInt = end / 32;
-    for (int i = firstInt; i <= lastInt; i++) {
-        int firstBit = i > firstInt ? 0 : start & 0x1F;
-        int lastBit = i < lastInt ? 31 : end & 0x1F;
-        int mask;
-        if (firstBit == 0 && lastBit == 31) {
-            mask = -1;
-        } else {
-            mask = 0;
-            for (int j = firstBit; j <= lastBit; j++) {
-                mask |= 1 << j;
-            }
-        }
+    int firstWord = start >> logBits;
+    int lastWord = end >> logBits;
+    for (int i = firstWord; i <= lastWord; i++) {
+        int firstBit = i > firstWord ? 0 : start & bitsMask;
+        int lastBit = i < lastWord ? bitsMask : end & bitsMask;
+        // bits firstBit..lastBit set
+        Word mask = (~(Word) 0 >> (bitsMask - lastBit)) & (~(Word) 0 << firstBit);
 
         // Return false if we're looking for 1s and the masked bits[i] isn't all 1s (that is,
         // equals the mask, or we're looking for 0s and the masked portion is not all 0s
@@ -94,42 +84,41 @@ bool BitArray::isRange(int start, int end, bool value) {
     return true;
 }
 
-vector<int>& BitArray::getBitArray() {
-    return bits->values();
+vector<BitArray::Word>& BitArray::getBitArray() {
+    return bits;
+}
+
+namespace {
+BitArray::Word reverseWord(BitArray::Word x) {
+    x = ((x >>  1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) <<  1);
+    x = ((x >>  2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) <<  2);
+    x = ((x >>  4) & 0x0f0f0f0f0f0f0f0fULL) | ((x & 0x0f0f0f0f0f0f0f0fULL) <<  4);
+    x = ((x >>  8) & 0x00ff00ff00ff00ffULL) | ((x & 0x00ff00ff00ff00ffULL) <<  8);
+    x = ((x >> 16) & 0x0000ffff0000ffffULL) | ((x & 0x0000ffff0000ffffULL) << 16);
+    return (x >> 32) | (x << 32);
+}
 }
 
 void BitArray::reverse()
 {
-    ArrayRef<int> newBits(bits->size());
-    // reverse all int's first
-    int len = ((this->size-1) / 32);
-    int oldBitsLen = len + 1;
-    for (int i = 0; i < oldBitsLen; i++) {
-      long x = (long) bits[i];
-      x = ((x >>  1) & 0x55555555L) | ((x & 0x55555555L) <<  1);
-      x = ((x >>  2) & 0x33333333L) | ((x & 0x33333333L) <<  2);
-      x = ((x >>  4) & 0x0f0f0f0fL) | ((x & 0x0f0f0f0fL) <<  4);
-      x = ((x >>  8) & 0x00ff00ffL) | ((x & 0x00ff00ffL) <<  8);
-      x = ((x >> 16) & 0x0000ffffL) | ((x & 0x0000ffffL) << 16);
-      newBits[len - i] = (int) x;
+    if (size == 0) {
+        return;
     }
-    // now correct the int's if the bit size isn't a multiple of 32
-    if (size != oldBitsLen * 32) {
-      int leftOffset = oldBitsLen * 32 - size;
-      int mask = 1;
-      for (int i = 0; i < 31 - leftOffset; i++) {
-        mask = (mask << 1) | 1;
-      }
-      int currentInt = (newBits[0] >> leftOffset) & mask;
-      for (int i = 1; i < oldBitsLen; i++) {
-        int nextInt = newBits[i];
-        currentInt |= nextInt << (32 - leftOffset);
-        newBits[i - 1] = currentInt;
-        currentInt = (nextInt >> leftOffset) & mask;
-      }
-      newBits[oldBitsLen - 1] = currentInt;
+    int words = makeArraySize(size);
+    vector<Word> newBits(bits.size());
+    // reverse the words and the bits in them, which leaves the row at the top of the last word
+    for (int i = 0; i < words; i++) {
+        newBits[words - 1 - i] = reverseWord(bits[i]);
+    }
+    // then shift it down when the size isn't a multiple of 64
+    int leftOffset = words * bitsPerWord - size;
+    if (leftOffset != 0) {
+        for (int i = 0; i < words - 1; i++) {
+            newBits[i] = (newBits[i] >> leftOffset) | (newBits[i + 1] << (bitsPerWord - leftOffset));
+        }
+        newBits[words - 1] >>= leftOffset;
     }
-    bits = newBits;
+    bits.swap(newBits);
 }
 
 BitArray::Reverse::Reverse(Ref<BitArray> array_) : array(array_) {
@@ -141,34 +130,30 @@ BitArray::Reverse::~Reverse() {
 }
 
 namespace {
-// N.B.: This only works for 32 bit ints ...
-int numberOfTrailingZeros(int i) {
-    // HD, Figure 5-14
+int numberOfTrailingZeros(BitArray::Word i) {
 #if defined(__clang__) || defined(__GNUC__)
-    return __builtin_ctz(i);
+    return __builtin_ctzll(i);
 #else
-    int y;
-    if (i == 0) return 32;
-    int n = 31;
-    y = i <<16; if (y != 0) { n = n -16; i = y; }
-    y = i << 8; if (y != 0) { n = n - 8; i = y; }
-    y = i << 4; if (y != 0) { n = n - 4; i = y; }
-    y = i << 2; if (y != 0) { n = n - 2; i = y; }
-    return n - (((unsigned int)(i << 1)) >> 31);
+    int n = 0;
+    while ((i & 1) == 0) {
+        i >>= 1;
+        n++;
+    }
+    return n;
 #endif
 }
 }
 
-int BitArray::getNextSet(int from) {
+int BitArray::getNextSet(int from) const {
     if (from >= size) {
         return size;
     }
     int bitsOffset = from >> logBits;
-    int currentBits = bits[bitsOffset];
     // mask off lesser bits first
-    currentBits &= ~((1 << (from & bitsMask)) - 1);
+    Word currentBits = bits[bitsOffset] & (~(Word) 0 << (from & bitsMask));
+    int words = makeArraySize(size);
     while (currentBits == 0) {
-        if (++bitsOffset == (int)bits->size()) {
+        if (++bitsOffset == words) {
             return size;
         }
         currentBits = bits[bitsOffset];
@@ -177,16 +162,16 @@ int BitArray::getNextSet(int from) {
     return result > size ? size : result;
 }
 
-int BitArray::getNextUnset(int from) {
+int BitArray::getNextUnset(int from) const {
     if (from >= size) {
         return size;
     }
     int bitsOffset = from >> logBits;
-    int currentBits = ~bits[bitsOffset];
     // mask off lesser bits first
-    currentBits &= ~((1 << (from & bitsMask)) - 1);
+    Word currentBits = ~bits[bitsOffset] & (~(Word) 0 << (from & bitsMask));
+    int words = makeArraySize(size);
     while (currentBits == 0) {
-        if (++bitsOffset == (int)bits->size()) {
+        if (++bitsOffset == words) {
             return size;
         }
         currentBits = ~bits[bitsOffset];
@@ -199,7 +184,7 @@ void BitArray::appendBit(bool bit)
 {
     ensureCapacity(size + 1);
     if (bit) {
-        bits[size / 32] |= 1 << (size & 0x1F);
+        set(size);
     }
     size++;
 }
@@ -226,24 +211,17 @@ void BitArray::appendBitArray(const BitArray& other)
 
 void BitArray::ensureCapacity(int size)
 {
-    if (size > bits->size() * 32)
-    {
-        ArrayRef<int> newBits = makeArray(size);
-        //memcpy(bits, newBits->, bits->size());
-        for (size_t i=0; i<bits->size(); ++i) {
-            newBits[i] = bits[i];
-        }
-        bits = newBits;
-
+    if (size > (int) bits.size() * bitsPerWord) {
+        bits.resize(makeArraySize(size));
     }
 }
 
 void BitArray::xor_(const BitArray& other)
 {
-    if (bits->size() != other.bits->size()) {
+    if (bits.size() != other.bits.size()) {
         throw IllegalArgumentException("Sizes don't match");
     }
-    for (int i = 0; i < bits->size(); i++) {
+    for (size_t i = 0; i < bits.size(); i++) {
         // The last byte could be incomplete (i.e. not have 8 bits in
         // it) but there is no problem since 0 XOR 0 == 0.
         bits[i] ^= other.bits[i];
@@ -22,6 +22,7 @@
 #include <zxing/common/Counted.h>
 #include <zxing/common/IllegalArgumentException.h>
 #include <zxing/common/Array.h>
+#include <stdint.h>
 #include <vector>
 #include <limits>
 #include <iostream>
@@ -29,14 +30,19 @@
 
 namespace zxing {
 
+/*
+ * A row of bits packed 64 to a word, bit i in bit (i & 63) of word i >> 6. Bits past the size in
+ * the last word are always clear.
+ */
 class BitArray : public Counted {
 public:
-    static const int bitsPerWord = std::numeric_limits<unsigned int>::digits;
+    typedef uint64_t Word;
+    static const int bitsPerWord = 64;
 
 private:
     int size;
-    ArrayRef<int> bits;
-    static const int logBits = ZX_LOG_DIGITS(bitsPerWord);
+    std::vector<Word> bits;
+    static const int logBits = 6;
     static const int bitsMask = (1 << logBits) - 1;
 
 public:
@@ -47,25 +53,28 @@ public:
     int getSizeInBytes() const;
 
     bool get(int i) const {
-        return (bits[i / 32] & (1 << (i & 0x1F))) != 0;
+        return ((bits[i >> logBits] >> (i & bitsMask)) & 1) != 0;
     }
 
     void set(int i) {
-        bits[i / 32] |= 1 << (i & 0x1F);
+        bits[i >> logBits] |= (Word) 1 << (i & bitsMask);
     }
 
     void flip(int i) {
-        bits[i / 32] ^= 1 << (i & 0x1F);
+        bits[i >> logBits] ^= (Word) 1 << (i & bitsMask);
       }
 
-    int getNextSet(int from);
-    int getNextUnset(int from);
+    // The first set (or unset) bit at or after from, or the size when there is none. Whole
+    // words are skipped at a time.
+    int getNextSet(int from) const;
+    int getNextUnset(int from) const;
 
-    void setBulk(int i, int newBits);
+    // Sets the 64 bits starting at i, which must be a multiple of 64.
+    void setBulk(int i, Word newBits);
     void setRange(int start, int end);
     void clear();
     bool isRange(int start, int end, bool value);
-    std::vector<int>& getBitArray();
+    std::vector<Word>& getBitArray();
 
     void appendBit(bool bit);
     void appendBits(int value, int numBits);
@@ -78,10 +87,6 @@ public:
 
     const std::string toString() const;
 
-    static ArrayRef<int> makeArray(int size) {
-        return ArrayRef<int>((size + 31) / 32);
-      }
-
     void reverse();
 
     class Reverse {
@@ -16,28 +16,66 @@
  */
 
 #include <zxing/common/BitMatrix.h>
+#include <zxing/common/Arena.h>
 #include <zxing/common/IllegalArgumentException.h>
 
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <string>
 
 using std::ostream;
 using std::ostringstream;
+using std::vector;
 
 using zxing::BitMatrix;
 using zxing::BitArray;
+using zxing::Arena;
+using zxing::ArenaVector;
 using zxing::ArrayRef;
 using zxing::Ref;
 
+namespace {
+const int CACHE_LINE_WORDS = 64 / sizeof(BitMatrix::Word);
+
+inline int numberOfTrailingZeros(BitMatrix::Word i) {
+#if defined(__clang__) || defined(__GNUC__)
+    return __builtin_ctzll(i);
+#else
+    int n = 0;
+    while ((i & 1) == 0) {
+        i >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+inline int numberOfLeadingZeros(BitMatrix::Word i) {
+#if defined(__clang__) || defined(__GNUC__)
+    return __builtin_clzll(i);
+#else
+    int n = 0;
+    while ((i & ((BitMatrix::Word) 1 << 63)) == 0) {
+        i <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+}
+
 void BitMatrix::init(int width, int height) {
     if (width < 1 || height < 1) {
         throw IllegalArgumentException("Both dimensions must be greater than 0");
     }
     this->width = width;
     this->height = height;
-    this->rowSize = (width + 31) >> 5;
-    bits = ArrayRef<int>(rowSize * height);
+    this->rowSize = (width + 63) >> 6;
+    // a sampled symbol is small enough to come from the decode's arena, a frame is not
+    storage = static_cast<Word*>(Arena::allocate((rowSize * height + CACHE_LINE_WORDS - 1) * sizeof(Word)));
+    bits = reinterpret_cast<Word*>((reinterpret_cast<size_t>(storage) + 63) & ~(size_t) 63);
+    memset(bits, 0, rowSize * height * sizeof(Word));
 }
 
 BitMatrix::BitMatrix(int dimension) {
@@ -48,11 +86,16 @@ BitMatrix::BitMatrix(int width, int height) {
     init(width, height);
 }
 
-BitMatrix::~BitMatrix() {}
+BitMatrix::~BitMatrix() {
+    Arena::deallocate(storage);
+}
 
 void BitMatrix::flip(int x, int y) {
-    int offset = y * rowSize + (x >> 5);
-    bits[offset] ^= 1 << (x & 0x1f);
+    bits[y * rowSize + (x >> 6)] ^= (Word) 1 << (x & 63);
+}
+
+void BitMatrix::clear() {
+    memset(bits, 0, rowSize * height * sizeof(Word));
 }
 
 void BitMatrix::rotate180()
@@ -71,6 +114,114 @@ void BitMatrix::rotate180()
     }
 }
 
+Ref<BitMatrix> BitMatrix::rotateCounterClockwise() const
+{
+    // (x, y) goes to (y, width - 1 - x); only set bits are visited
+    Ref<BitMatrix> rotated( new BitMatrix(height, width) );
+    for (int y = 0; y < height; y++) {
+        const Word* row = getRowWords(y);
+        for (int word = 0; word < rowSize; word++) {
+            Word current = row[word];
+            while (current != 0) {
+                int x = (word << 6) + numberOfTrailingZeros(current);
+                current &= current - 1;
+                rotated->set(y, width - 1 - x);
+            }
+        }
+    }
+    return rotated;
+}
+
+int BitMatrix::getNextSet(int x, int y) const {
+    if (x >= width) {
+        return width;
+    }
+    const Word* row = getRowWords(y);
+    int word = x >> 6;
+    Word current = row[word] & (~(Word) 0 << (x & 63));
+    while (current == 0) {
+        if (++word == rowSize) {
+            return width;
+        }
+        current = row[word];
+    }
+    return (word << 6) + numberOfTrailingZeros(current);
+}
+
+int BitMatrix::getNextUnset(int x, int y) const {
+    if (x >= width) {
+        return width;
+    }
+    const Word* row = getRowWords(y);
+    int word = x >> 6;
+    Word current = ~row[word] & (~(Word) 0 << (x & 63));
+    while (current == 0) {
+        if (++word == rowSize) {
+            return width;
+        }
+        current = ~row[word];
+    }
+    int result = (word << 6) + numberOfTrailingZeros(current);
+    return result > width ? width : result;
+}
+
+int BitMatrix::getPreviousSet(int x, int y) const {
+    if (x < 0) {
+        return -1;
+    }
+    const Word* row = getRowWords(y);
+    int word = x >> 6;
+    Word current = row[word] & (~(Word) 0 >> (63 - (x & 63)));
+    while (current == 0) {
+        if (--word < 0) {
+            return -1;
+        }
+        current = row[word];
+    }
+    return (word << 6) + 63 - numberOfLeadingZeros(current);
+}
+
+int BitMatrix::getPreviousUnset(int x, int y) const {
+    if (x < 0) {
+        return -1;
+    }
+    const Word* row = getRowWords(y);
+    int word = x >> 6;
+    Word current = ~row[word] & (~(Word) 0 >> (63 - (x & 63)));
+    while (current == 0) {
+        if (--word < 0) {
+            return -1;
+        }
+        current = ~row[word];
+    }
+    return (word << 6) + 63 - numberOfLeadingZeros(current);
+}
+
+void BitMatrix::getRowRuns(int y, ArenaVector<int>& runs) const {
+    runs.clear();
+    const Word* row = getRowWords(y);
+    // A run starts at every bit that differs from the one before it, taking the bit before the
+    // row to be white. The bits past the width are clear, so only a black run ending at the width
+    // can show a start beyond it.
+    int runStart = 0;
+    Word carry = 0;
+    for (int word = 0; word < rowSize; word++) {
+        Word current = row[word];
+        Word starts = current ^ ((current << 1) | carry);
+        carry = current >> 63;
+        while (starts != 0) {
+            int x = (word << 6) + numberOfTrailingZeros(starts);
+            if (x >= width) {
+                break;
+            }
+            starts &= starts - 1;
+            runs.push_back(x - runStart);
+            runStart = x;
+        }
+    }
+    runs.push_back(width - runStart);
+}
+
 void BitMatrix::setRegion(int left, int top, int width, int height) {
     if (top < 0 || left < 0) {
         throw IllegalArgumentException("Left and top must be nonnegative");
@@ -84,9 +235,9 @@ void BitMatrix::setRegion(int left, int top, int width, int height) {
         throw IllegalArgumentException("The region must fit inside the matrix");
     }
     for (int y = top; y < bottom; y++) {
-        int offset = y * rowSize;
+        Word* row = getRowWords(y);
         for (int x = left; x < right; x++) {
-            bits[offset + (x >> 5)] |= 1 << (x & 0x1f);
+            row[x >> 6] |= (Word) 1 << (x & 63);
         }
     }
 }
@@ -94,25 +245,22 @@ void BitMatrix::setRegion(int left, int top, int width, int height) {
 Ref<BitArray> BitMatrix::getRow(int y, Ref<BitArray> row) {
     if (row.empty() || row->getSize() < width) {
         row = new BitArray(width);
+    } else {
+        row->clear();
     }
-    int offset = y * rowSize;
-    for (int x = 0; x < rowSize; x++) {
-        row->setBulk(x << 5, bits[offset + x]);
-    }
+    memcpy(&row->getBitArray()[0], getRowWords(y), rowSize * sizeof(Word));
     return row;
 }
 
 void BitMatrix::setRow(int y, Ref<zxing::BitArray> row)
 {
-    if (y < 0 || y >= bits->size() ||
+    if (y < 0 || y >= height ||
             row->getSize() != width)
     {
         throw IllegalArgumentException("setRow arguments invalid");
     }
 
-    //change with memcopy
-    for(size_t i=0; i<width; i++)
-        bits[y * rowSize + i] = row->get(i);
+    memcpy(getRowWords(y), &row->getBitArray()[0], rowSize * sizeof(Word));
 }
 
 int BitMatrix::getWidth() const {
@@ -125,21 +273,15 @@ int BitMatrix::getHeight() const {
 
 ArrayRef<int> BitMatrix::getTopLeftOnBit() const {
     int bitsOffset = 0;
-    while (bitsOffset < bits->size() && bits[bitsOffset] == 0) {
+    int total = rowSize * height;
+    while (bitsOffset < total && bits[bitsOffset] == 0) {
         bitsOffset++;
     }
-    if (bitsOffset == bits->size()) {
+    if (bitsOffset == total) {
         return ArrayRef<int>();
     }
     int y = bitsOffset / rowSize;
-    int x = (bitsOffset % rowSize) << 5;
-
-    int theBits = bits[bitsOffset];
-    int bit = 0;
-    while ((theBits << (31-bit)) == 0) {
-        bit++;
-    }
-    x += bit;
+    int x = ((bitsOffset % rowSize) << 6) + numberOfTrailingZeros(bits[bitsOffset]);
     ArrayRef<int> res (2);
     res[0]=x;
     res[1]=y;
@@ -147,7 +289,7 @@ ArrayRef<int> BitMatrix::getTopLeftOnBit() const {
 }
 
 ArrayRef<int> BitMatrix::getBottomRightOnBit() const {
-    int bitsOffset = bits->size() - 1;
+    int bitsOffset = rowSize * height - 1;
     while (bitsOffset >= 0 && bits[bitsOffset] == 0) {
         bitsOffset--;
     }
@@ -156,14 +298,7 @@ ArrayRef<int> BitMatrix::getBottomRightOnBit() const {
     }
 
     int y = bitsOffset / rowSize;
-    int x = (bitsOffset % rowSize) << 5;
-
-    int theBits = bits[bitsOffset];
-    int bit = 31;
-    while ((theBits >> bit) == 0) {
-        bit--;
-    }
-    x += bit;
+    int x = ((bitsOffset % rowSize) << 6) + 63 - numberOfLeadingZeros(bits[bitsOffset]);
 
     ArrayRef<int> res (2);
     res[0]=x;
@@ -179,8 +314,9 @@ ArrayRef<int> BitMatrix::getEnclosingRectangle() const
     int bottom = -1;
 
     for (int y = 0; y < height; y++) {
-        for (int x32 = 0; x32 < rowSize; x32++) {
-            int theBits = bits[y * rowSize + x32];
+        const Word* row = getRowWords(y);
+        for (int x64 = 0; x64 < rowSize; x64++) {
+            Word theBits = row[x64];
             if (theBits != 0) {
                 if (y < top) {
                     top = y;
@@ -188,23 +324,13 @@ ArrayRef<int> BitMatrix::getEnclosingRectangle() const
                 if (y > bottom) {
                     bottom = y;
                 }
-                if (x32 * 32 < left) {
-                    int bit = 0;
-                    while ((theBits << (31 - bit)) == 0) {
-                        bit++;
-                    }
-                    if ((x32 * 32 + bit) < left) {
-                        left = x32 * 32 + bit;
-                    }
+                int first = (x64 << 6) + numberOfTrailingZeros(theBits);
+                if (first < left) {
+                    left = first;
                 }
-                if (x32 * 32 + 31 > right) {
-                    int bit = 31;
-                    while (((unsigned)theBits >> (unsigned)bit) == 0) {
-                        bit--;
-                    }
-                    if ((x32 * 32 + bit) > right) {
-                        right = x32 * 32 + bit;
-                    }
+                int last = (x64 << 6) + 63 - numberOfLeadingZeros(theBits);
+                if (last > right) {
+                    right = last;
                 }
             }
         }
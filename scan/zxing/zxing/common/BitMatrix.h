@@ -25,29 +25,27 @@
 #include <zxing/common/BitArray.h>
 #include <zxing/common/Array.h>
 #include <limits>
+#include <vector>
 
 namespace zxing {
 
+/*
+ * Bits packed 64 to a word, row after row in one block that starts on a cache line. Bit x of row y
+ * is bit (x & 63) of word (x >> 6) of the row, and bits past the width are always clear, so rows
+ * can be read a word at a time in place.
+ */
 class BitMatrix : public Counted {
 public:
-  static const int bitsPerWord = std::numeric_limits<unsigned int>::digits;
+  typedef BitArray::Word Word;
+  static const int bitsPerWord = 64;
 
 private:
   int width;
   int height;
   int rowSize;
-  ArrayRef<int> bits;
-
-//#define ZX_LOG_DIGITS(digits) \
-//    ((digits == 8) ? 3 : \
-//     ((digits == 16) ? 4 : \
-//      ((digits == 32) ? 5 : \
-//       ((digits == 64) ? 6 : \
-//        ((digits == 128) ? 7 : \
-//         (-1))))))
-
-//  static const int logBits = ZX_LOG_DIGITS(bitsPerWord);
-//  static const int bitsMask = (1 << logBits) - 1;
+  Word* bits;
+  // what was allocated; bits is the first cache line boundary in it
+  Word* storage;
 
 public:
   BitMatrix(int dimension);
@@ -56,17 +54,38 @@ public:
   ~BitMatrix();
 
   bool get(int x, int y) const {
-    int offset = y * rowSize + (x >> 5);
-    return ((((unsigned)bits[offset]) >> (x & 0x1f)) & 1) != 0;
+    return ((bits[y * rowSize + (x >> 6)] >> (x & 63)) & 1) != 0;
   }
 
   void set(int x, int y) {
-    int offset = y * rowSize + (x >> 5);
-    bits[offset] |= 1 << (x & 0x1f);
+    bits[y * rowSize + (x >> 6)] |= (Word) 1 << (x & 63);
   }
 
+  // The words of row y, read and written in place. For filling or scanning a row 64 bits at a time.
+  Word* getRowWords(int y) {
+    return bits + y * rowSize;
+  }
+  const Word* getRowWords(int y) const {
+    return bits + y * rowSize;
+  }
+  int getRowSize() const {
+    return rowSize;
+  }
+
+  // The first set (or unset) bit of row y at or after x, or the width when there is none
+  int getNextSet(int x, int y) const;
+  int getNextUnset(int x, int y) const;
+  // The last set (or unset) bit of row y at or before x, or -1 when there is none
+  int getPreviousSet(int x, int y) const;
+  int getPreviousUnset(int x, int y) const;
+  // The lengths of the runs of row y, alternately white and black and starting with white, so the
+  // first is 0 when the row starts black; they add up to the width.
+  void getRowRuns(int y, ArenaVector<int>& runs) const;
+
   void flip(int x, int y);
   void rotate180();
+  // A new matrix turned a quarter counter-clockwise, the way LuminanceSource rotates
+  Ref<BitMatrix> rotateCounterClockwise() const;
 
   void clear();
   void setRegion(int left, int top, int width, int height);
@@ -18,28 +18,45 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <iostream>
+#include <zxing/common/Arena.h>
 
 namespace zxing {
 
-/* base class for reference-counted objects */
+/* base class for reference-counted objects; the count is atomic, so objects can be shared between
+   threads, e.g. the GenericGF fields and the Version tables used by every decoder */
 class Counted {
 private:
-  unsigned int count_;
+  std::atomic<unsigned int> count_;
 public:
   Counted() :
       count_(0) {
   }
+  // a copy is a new object, with no references to it yet
+  Counted(const Counted&) :
+      count_(0) {
+  }
+  Counted& operator=(const Counted&) {
+    return *this;
+  }
   virtual ~Counted() {
   }
+  // made inside an Arena::Scope, an object comes from the decode's arena
+  static void* operator new(size_t size) {
+    return Arena::allocate(size);
+  }
+  static void operator delete(void* p) {
+    Arena::deallocate(p);
+  }
   Counted *retain() {
-    count_++;
+    count_.fetch_add(1, std::memory_order_relaxed);
     return this;
   }
   void release() {
-    count_--;
-    if (count_ == 0) {
-      count_ = 0xDEADF001;
+    // the last release must see every write made through the other references before deleting
+    if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      count_.store(0xDEADF001, std::memory_order_relaxed);
       delete this;
     }
   }
@@ -47,7 +64,7 @@ public:
 
   /* return the current count for denugging purposes or similar */
   int count() const {
-    return count_;
+    return count_.load(std::memory_order_relaxed);
   }
 };
 
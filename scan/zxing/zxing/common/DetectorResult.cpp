@@ -28,6 +28,12 @@ DetectorResult::DetectorResult(Ref<BitMatrix> bits,
   : bits_(bits), points_(points) {
 }
 
+DetectorResult::DetectorResult(Ref<BitMatrix> bits,
+                               ArrayRef< Ref<ResultPoint> > points,
+                               Ref<BitMatrix> doubtful)
+  : bits_(bits), points_(points), doubtful_(doubtful) {
+}
+
 Ref<BitMatrix> DetectorResult::getBits() {
   return bits_;
 }
@@ -36,4 +42,8 @@ ArrayRef< Ref<ResultPoint> > DetectorResult::getPoints() {
   return points_;
 }
 
+Ref<BitMatrix> DetectorResult::getDoubtful() {
+  return doubtful_;
+}
+
 }
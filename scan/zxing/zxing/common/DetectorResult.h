@@ -31,11 +31,15 @@ class DetectorResult : public Counted {
 private:
   Ref<BitMatrix> bits_;
   ArrayRef< Ref<ResultPoint> > points_;
+  Ref<BitMatrix> doubtful_;
 
 public:
   DetectorResult(Ref<BitMatrix> bits, ArrayRef< Ref<ResultPoint> > points);
+  DetectorResult(Ref<BitMatrix> bits, ArrayRef< Ref<ResultPoint> > points, Ref<BitMatrix> doubtful);
   Ref<BitMatrix> getBits();
   ArrayRef< Ref<ResultPoint> > getPoints();
+  // The modules of getBits() that were uncertain when sampled; empty if the detector doesn't say
+  Ref<BitMatrix> getDoubtful();
 };
 
 }
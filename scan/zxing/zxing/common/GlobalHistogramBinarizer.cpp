@@ -22,6 +22,14 @@
 #include <zxing/NotFoundException.h>
 #include <zxing/common/Array.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GHB_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 using zxing::Binarizer;
 using zxing::ArrayRef;
 using zxing::Ref;
@@ -53,7 +61,79 @@ void GlobalHistogramBinarizer::initArrays(int luminanceSize) {
     memset(&buckets[0], 0, sizeof(int) * LUMINANCE_BUCKETS);
 }
 
+namespace {
+
+// Adds count luminances to the buckets. Four histograms are kept in turn so that runs of equal
+// pixels do not wait on each other's increments, and are summed at the end.
+void addToHistogram(const byte* luminances, int count, ArrayRef<int>& buckets) {
+    int partial[4][LUMINANCE_BUCKETS] = {{0}};
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        partial[0][luminances[x] >> LUMINANCE_SHIFT]++;
+        partial[1][luminances[x + 1] >> LUMINANCE_SHIFT]++;
+        partial[2][luminances[x + 2] >> LUMINANCE_SHIFT]++;
+        partial[3][luminances[x + 3] >> LUMINANCE_SHIFT]++;
+    }
+    for (; x < count; x++) {
+        partial[0][luminances[x] >> LUMINANCE_SHIFT]++;
+    }
+    for (int i = 0; i < LUMINANCE_BUCKETS; i++) {
+        buckets[i] += partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+    }
+}
+
+// Sets bit x of words for every pixel of the row below blackPoint, filling 64 pixels, one word,
+// at a time.
+void thresholdRow(const byte* luminances, int width, int blackPoint, BitMatrix::Word* words) {
+    typedef BitMatrix::Word Word;
+    if (blackPoint <= 0) {
+        return;
+    }
+    int x = 0;
+#ifdef __AVX2__
+    // pixel < blackPoint exactly when min(pixel, blackPoint - 1) == pixel
+    const __m256i limit32 = _mm256_set1_epi8((char) (blackPoint - 1));
+    for (; x + 64 <= width; x += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(luminances + x));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(luminances + x + 32));
+        unsigned int lowMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(low, limit32), low));
+        unsigned int highMask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(high, limit32), high));
+        words[x >> 6] = (Word) lowMask | ((Word) highMask << 32);
+    }
+#endif
+#ifdef GHB_SSE2
+    const __m128i limit = _mm_set1_epi8((char) (blackPoint - 1));
+    for (; x + 64 <= width; x += 64) {
+        Word word = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luminances + x + 16 * i));
+            Word mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(pixels, limit), pixels));
+            word |= mask << (16 * i);
+        }
+        words[x >> 6] = word;
+    }
+#endif
+    for (; x < width; x += 64) {
+        int end = x + 64 < width ? x + 64 : width;
+        Word word = 0;
+        for (int i = x; i < end; i++) {
+            word |= (Word) (luminances[i] < blackPoint) << (i - x);
+        }
+        words[x >> 6] = word;
+    }
+}
+
+}
+
 Ref<BitArray> GlobalHistogramBinarizer::getBlackRow(int y, Ref<BitArray> row) {
+    Ref<BitArray> blackRow = tryGetBlackRow(y, row);
+    if (blackRow == NULL) {
+        throw NotFoundException();
+    }
+    return blackRow;
+}
+
+Ref<BitArray> GlobalHistogramBinarizer::tryGetBlackRow(int y, Ref<BitArray> row) {
     // std::cerr << "gbr " << y << std::endl;
     LuminanceSource& source = *getLuminanceSource();
     int width = source.getWidth();
@@ -64,21 +144,23 @@ Ref<BitArray> GlobalHistogramBinarizer::getBlackRow(int y, Ref<BitArray> row) {
     }
 
     initArrays(width);
-    ArrayRef<byte> localLuminances = source.getRow(y, luminances);
-    if (false) {
-        std::cerr << "gbr " << y << " r ";
-        for(int i=0, e=localLuminances->size(); i < e; ++i) {
-            std::cerr << 0+localLuminances[i] << " ";
-        }
-        std::cerr << std::endl;
+    // read the row in place when the source exposes its plane
+    int stride;
+    const byte* localLuminances = source.getPlane(stride);
+    ArrayRef<byte> rowCopy;
+    if (localLuminances) {
+        localLuminances += y * stride;
+    } else {
+        rowCopy = source.getRow(y, luminances);
+        localLuminances = &rowCopy[0];
     }
     ArrayRef<int> localBuckets = buckets;
-    for (int x = 0; x < width; x++) {
-        int pixel = localLuminances[x] & 0xff;
-        localBuckets[pixel >> LUMINANCE_SHIFT]++;
-    }
-    int blackPoint = estimateBlackPoint(localBuckets);
+    addToHistogram(localLuminances, width, localBuckets);
+    int blackPoint = tryEstimateBlackPoint(localBuckets);
     // std::cerr << "gbr bp " << y << " " << blackPoint << std::endl;
+    if (blackPoint < 0) {
+        return Ref<BitArray>();
+    }
 
     int left = localLuminances[0] & 0xff;
     int center = localLuminances[1] & 0xff;
@@ -105,28 +187,34 @@ Ref<BitMatrix> GlobalHistogramBinarizer::getBlackMatrix() {
     // This proved to be more robust on the blackbox tests than sampling a
     // diagonal as we used to do.
     initArrays(width);
+    int stride;
+    const byte* plane = source.getPlane(stride);
     ArrayRef<int> localBuckets = buckets;
     for (int y = 1; y < 5; y++) {
         int row = height * y / 5;
-        ArrayRef<byte> localLuminances = source.getRow(row, luminances);
-        int right = (width << 2) / 5;
-        for (int x = width / 5; x < right; x++) {
-            int pixel = localLuminances[x] & 0xff;
-            localBuckets[pixel >> LUMINANCE_SHIFT]++;
+        ArrayRef<byte> rowCopy;
+        const byte* localLuminances;
+        if (plane) {
+            localLuminances = plane + row * stride;
+        } else {
+            rowCopy = source.getRow(row, luminances);
+            localLuminances = &rowCopy[0];
         }
+        int left = width / 5;
+        int right = (width << 2) / 5;
+        addToHistogram(localLuminances + left, right - left, localBuckets);
     }
 
     int blackPoint = estimateBlackPoint(localBuckets);
 
-    ArrayRef<byte> localLuminances = source.getMatrix();
+    ArrayRef<byte> matrixCopy;
+    if (!plane) {
+        matrixCopy = source.getMatrix();
+        plane = &matrixCopy[0];
+        stride = width;
+    }
     for (int y = 0; y < height; y++) {
-        int offset = y * width;
-        for (int x = 0; x < width; x++) {
-            int pixel = localLuminances[offset + x] & 0xff;
-            if (pixel < blackPoint) {
-                matrix->set(x, y);
-            }
-        }
+        thresholdRow(plane + y * stride, width, blackPoint, matrix->getRowWords(y));
     }
 
     return matrix;
@@ -135,6 +223,14 @@ Ref<BitMatrix> GlobalHistogramBinarizer::getBlackMatrix() {
 using namespace std;
 
 int GlobalHistogramBinarizer::estimateBlackPoint(ArrayRef<int> const& buckets) {
+    int blackPoint = tryEstimateBlackPoint(buckets);
+    if (blackPoint < 0) {
+        throw NotFoundException();
+    }
+    return blackPoint;
+}
+
+int GlobalHistogramBinarizer::tryEstimateBlackPoint(ArrayRef<int> const& buckets) {
     // Find tallest peak in histogram
     int numBuckets = buckets->size();
     int maxBucketCount = 0;
@@ -185,7 +281,7 @@ int GlobalHistogramBinarizer::estimateBlackPoint(ArrayRef<int> const& buckets) {
     // "<= 1/16 of the total histogram buckets apart"
     // std::cerr << "! " << secondPeak << " " << firstPeak << " " << numBuckets << std::endl;
     if (secondPeak - firstPeak <= numBuckets >> 4) {
-        throw NotFoundException();
+        return -1;
     }
 
     // Find a valley between them that is low and closer to the white peak
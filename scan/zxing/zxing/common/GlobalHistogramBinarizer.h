@@ -36,8 +36,11 @@ public:
   virtual ~GlobalHistogramBinarizer();
 		
   virtual Ref<BitArray> getBlackRow(int y, Ref<BitArray> row);
+  virtual Ref<BitArray> tryGetBlackRow(int y, Ref<BitArray> row);
   virtual Ref<BitMatrix> getBlackMatrix();
   static int estimateBlackPoint(ArrayRef<int> const& buckets);
+  // As estimateBlackPoint(), but returns -1 when the histogram has too little dynamic range
+  static int tryEstimateBlackPoint(ArrayRef<int> const& buckets);
   Ref<Binarizer> createBinarizer(Ref<LuminanceSource> source);
 private:
   void initArrays(int luminanceSize);
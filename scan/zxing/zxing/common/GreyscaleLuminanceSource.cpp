@@ -70,6 +70,14 @@ ArrayRef<byte> GreyscaleLuminanceSource::getMatrix() const {
   }
 }
 
+const byte* GreyscaleLuminanceSource::getPlane(int& stride) const {
+  if (getWidth() == 0 || getHeight() == 0) {
+    return NULL;
+  }
+  stride = dataWidth_;
+  return &greyData_[top_ * dataWidth_ + left_];
+}
+
 Ref<LuminanceSource> GreyscaleLuminanceSource::rotateCounterClockwise() const {
   // Intentionally flip the left, top, width, and height arguments as
   // needed. dataWidth and dataHeight are always kept unrotated.
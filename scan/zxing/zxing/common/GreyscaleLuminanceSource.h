@@ -40,6 +40,7 @@ public:
 
   ArrayRef<byte> getRow(int y, ArrayRef<byte> row) const;
   ArrayRef<byte> getMatrix() const;
+  const byte* getPlane(int& stride) const;
 
   bool isRotateSupported() const {
     return true;
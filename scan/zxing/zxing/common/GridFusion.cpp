@@ -0,0 +1,138 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  Copyright 2010 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/GridFusion.h>
+#include <cstdlib>
+
+using zxing::GridFusion;
+using zxing::BitMatrix;
+using zxing::Ref;
+
+GridFusion::GridFusion() : dimension_(0), heldDimension_(0), voted_(false), stray_(false), strays_(0) {
+}
+
+void GridFusion::nextFrame() {
+  strays_ = voted_ ? 0 : strays_ + (stray_ ? 1 : 0);
+  stray_ = false;
+  voted_ = false;
+}
+
+void GridFusion::add(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful) {
+  heldDimension_ = bits->getWidth() == bits->getHeight() ? bits->getHeight() : 0;
+  held_.resize(heldDimension_ * heldDimension_);
+  for (int y = 0, i = 0; y < heldDimension_; y++) {
+    for (int x = 0; x < heldDimension_; x++, i++) {
+      signed char weight = doubtful && doubtful->get(x, y) ? 1 : 2;
+      held_[i] = bits->get(x, y) ? weight : -weight;
+    }
+  }
+}
+
+// A grid that disagrees with the vote is more often a bad sampling of the same symbol (a wrong
+// alignment pattern, say) than another symbol, so it is left out; only when the next frame
+// disagrees too does the vote start over.
+void GridFusion::vote() {
+  if (heldDimension_ == 0) {
+    return;
+  }
+  if (heldDimension_ != dimension_) {
+    startOver();
+  } else if ((int)frames_.size() > (voted_ ? 1 : 0)) {
+    // against the earlier frames only, when this one is replacing its vote
+    const std::vector<signed char>* own = voted_ ? &frames_.back() : 0;
+    int agreeing = 0;
+    for (size_t i = 0; i < held_.size(); i++) {
+      int sum = own ? sums_[i] - (*own)[i] : sums_[i];
+      if (sum != 0 && (sum > 0) == (held_[i] > 0)) {
+        agreeing++;
+      }
+    }
+    if (agreeing * 4 < (int)held_.size() * 3) {
+      if (strays_ == 0) {
+        stray_ = true;
+        return;
+      }
+      startOver();
+    }
+  }
+
+  if (voted_) {
+    drop(frames_.back());
+    frames_.pop_back();
+  }
+  for (size_t i = 0; i < held_.size(); i++) {
+    sums_[i] += held_[i];
+  }
+  frames_.push_back(held_);
+  if ((int)frames_.size() > MAX_FRAMES) {
+    drop(frames_.front());
+    frames_.pop_front();
+  }
+  voted_ = true;
+}
+
+void GridFusion::reset() {
+  frames_.clear();
+  sums_.assign(sums_.size(), 0);
+  voted_ = false;
+  stray_ = false;
+  strays_ = 0;
+}
+
+int GridFusion::getFrameCount() const {
+  return frames_.size();
+}
+
+Ref<BitMatrix> GridFusion::getBits() const {
+  Ref<BitMatrix> bits(new BitMatrix(dimension_));
+  for (int y = 0, i = 0; y < dimension_; y++) {
+    for (int x = 0; x < dimension_; x++, i++) {
+      if (sums_[i] > 0) {
+        bits->set(x, y);
+      }
+    }
+  }
+  return bits;
+}
+
+// Doubtful where the vote is weaker than one sure vote per two frames: a split, or frames that
+// were mostly unsure themselves.
+Ref<BitMatrix> GridFusion::getDoubtful() const {
+  Ref<BitMatrix> doubtful(new BitMatrix(dimension_));
+  int frames = frames_.size();
+  for (int y = 0, i = 0; y < dimension_; y++) {
+    for (int x = 0; x < dimension_; x++, i++) {
+      if (std::abs(sums_[i]) < frames) {
+        doubtful->set(x, y);
+      }
+    }
+  }
+  return doubtful;
+}
+
+void GridFusion::startOver() {
+  dimension_ = heldDimension_;
+  frames_.clear();
+  sums_.assign(dimension_ * dimension_, 0);
+  voted_ = false;
+}
+
+void GridFusion::drop(const std::vector<signed char>& votes) {
+  for (size_t i = 0; i < votes.size(); i++) {
+    sums_[i] -= votes[i];
+  }
+}
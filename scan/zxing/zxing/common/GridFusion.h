@@ -0,0 +1,77 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __GRID_FUSION_H__
+#define __GRID_FUSION_H__
+
+/*
+ *  Copyright 2010 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/Counted.h>
+#include <zxing/common/BitMatrix.h>
+#include <deque>
+#include <vector>
+
+namespace zxing {
+
+/* Votes the module grids a detector sampled from one symbol in consecutive video frames into a
+   single grid, so that a symbol no one frame shows well enough can still be decoded. The grids
+   are in module coordinates, so they line up whatever the symbol did in the frame. A grid of
+   another dimension starts the vote over, as does one that disagrees with the vote so far on
+   more than a quarter of its modules in two frames running. Only the last MAX_FRAMES
+   frames vote. Not thread safe: one per decoding thread, passed in through DecodeHints. */
+class GridFusion : public Counted {
+public:
+  static const int MAX_FRAMES = 8;
+
+  GridFusion();
+
+  // Starts the next frame. Each frame votes once, however many attempts its decode makes: a
+  // later vote in the same frame replaces the earlier one.
+  void nextFrame();
+  // Holds a grid as sampled, before decoding unmasks it; doubtful as from
+  // DetectorResult::getDoubtful(). It only counts once vote() is called, which a reader does when
+  // the grid turns out to be a symbol (its format information could be read).
+  void add(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful);
+  void vote();
+  void reset();
+
+  int getFrameCount() const;
+  // The majority of the frames, and the modules where they are split or were all unsure
+  Ref<BitMatrix> getBits() const;
+  Ref<BitMatrix> getDoubtful() const;
+
+private:
+  void startOver();
+  void drop(const std::vector<signed char>& votes);
+
+  int dimension_;
+  // the votes of the grid last added
+  std::vector<signed char> held_;
+  int heldDimension_;
+  // whether the current frame has voted, its votes being the newest
+  bool voted_;
+  // the votes of each frame, oldest first: 2 for a module sampled black, -2 for white, and
+  // half that if it was doubtful
+  std::deque<std::vector<signed char> > frames_;
+  std::vector<int> sums_;
+  // whether the current frame had a grid left out for disagreeing, and how many frames in a row
+  // before it did
+  bool stray_;
+  int strays_;
+};
+
+}
+
+#endif // __GRID_FUSION_H__
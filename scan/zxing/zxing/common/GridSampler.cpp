@@ -23,6 +23,7 @@
 #include <zxing/ReaderException.h>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 namespace zxing {
 using namespace std;
@@ -34,7 +35,7 @@ GridSampler::GridSampler() {
 
 Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimension, Ref<PerspectiveTransform> transform) {
   Ref<BitMatrix> bits(new BitMatrix(dimension));
-  vector<float> points(dimension << 1, (const float)0.0f);
+  ArenaVector<float> points(dimension << 1, (const float)0.0f);
   for (int y = 0; y < dimension; y++) {
     int max = points.size();
     float yValue = (float)y + 0.5f;
@@ -55,7 +56,7 @@ Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimension, Ref<
 
 Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimensionX, int dimensionY, Ref<PerspectiveTransform> transform) {
   Ref<BitMatrix> bits(new BitMatrix(dimensionX, dimensionY));
-  vector<float> points(dimensionX << 1, (const float)0.0f);
+  ArenaVector<float> points(dimensionX << 1, (const float)0.0f);
   for (int y = 0; y < dimensionY; y++) {
     int max = points.size();
     float yValue = (float)y + 0.5f;
@@ -84,7 +85,49 @@ Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimension, floa
 
 }
 
-void GridSampler::checkAndNudgePoints(Ref<BitMatrix> image, vector<float> &points) {
+// Four more samples per module, a quarter of a module in from its corners. Where a smudge or a
+// blurred edge crosses the module they disagree with the sample at its centre, and once two of
+// them do, the centre sample is about as likely to be wrong as right.
+Ref<BitMatrix> GridSampler::sampleDoubtfulModules(Ref<BitMatrix> image, Ref<BitMatrix> bits,
+                                                  Ref<PerspectiveTransform> transform) {
+  int dimensionX = bits->getWidth();
+  int dimensionY = bits->getHeight();
+  int width = image->getWidth();
+  int height = image->getHeight();
+  Ref<BitMatrix> doubtful(new BitMatrix(dimensionX, dimensionY));
+  ArenaVector<float> points(dimensionX << 2, 0.0f);
+  ArenaVector<int> disagreeing(dimensionX);
+  for (int y = 0; y < dimensionY; y++) {
+    std::fill(disagreeing.begin(), disagreeing.end(), 0);
+    for (int half = 0; half < 2; half++) {
+      float yValue = (float)y + (half ? 0.75f : 0.25f);
+      for (int x = 0; x < dimensionX; x++) {
+        points[x << 2] = (float)x + 0.25f;
+        points[(x << 2) + 1] = yValue;
+        points[(x << 2) + 2] = (float)x + 0.75f;
+        points[(x << 2) + 3] = yValue;
+      }
+      transform->transformPoints(points);
+      for (size_t i = 0; i < points.size(); i += 2) {
+        // the centres were all in bounds, so these are at most a pixel or two out
+        int imageX = std::min(std::max((int)points[i], 0), width - 1);
+        int imageY = std::min(std::max((int)points[i + 1], 0), height - 1);
+        int x = (int)(i >> 2);
+        if (image->get(imageX, imageY) != bits->get(x, y)) {
+          disagreeing[x]++;
+        }
+      }
+    }
+    for (int x = 0; x < dimensionX; x++) {
+      if (disagreeing[x] >= 2) {
+        doubtful->set(x, y);
+      }
+    }
+  }
+  return doubtful;
+}
+
+void GridSampler::checkAndNudgePoints(Ref<BitMatrix> image, ArenaVector<float> &points) {
   int width = image->getWidth();
   int height = image->getHeight();
 
@@ -37,7 +37,9 @@ public:
   Ref<BitMatrix> sampleGrid(Ref<BitMatrix> image, int dimension, float p1ToX, float p1ToY, float p2ToX, float p2ToY,
                             float p3ToX, float p3ToY, float p4ToX, float p4ToY, float p1FromX, float p1FromY, float p2FromX,
                             float p2FromY, float p3FromX, float p3FromY, float p4FromX, float p4FromY);
-  static void checkAndNudgePoints(Ref<BitMatrix> image, std::vector<float> &points);
+  // Modules of bits, as sampled from image, whose value is in doubt
+  Ref<BitMatrix> sampleDoubtfulModules(Ref<BitMatrix> image, Ref<BitMatrix> bits, Ref<PerspectiveTransform> transform);
+  static void checkAndNudgePoints(Ref<BitMatrix> image, ArenaVector<float> &points);
   static GridSampler &getInstance();
 };
 }
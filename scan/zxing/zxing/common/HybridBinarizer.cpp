@@ -22,6 +22,11 @@
 
 #include <zxing/common/IllegalArgumentException.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HB_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 using namespace zxing;
 
@@ -59,7 +64,15 @@ Ref<BitMatrix> HybridBinarizer::getBlackMatrix() {
   int width = source.getWidth();
   int height = source.getHeight();
   if (width >= MINIMUM_DIMENSION && height >= MINIMUM_DIMENSION) {
-    ArrayRef<byte> luminances = source.getMatrix();
+    // threshold the source's own plane when it has one, otherwise a copy of it
+    int stride;
+    const byte* luminances = source.getPlane(stride);
+    ArrayRef<byte> matrixCopy;
+    if (!luminances) {
+      matrixCopy = source.getMatrix();
+      luminances = &matrixCopy[0];
+      stride = width;
+    }
     int subWidth = width >> BLOCK_SIZE_POWER;
     if ((width & BLOCK_SIZE_MASK) != 0) {
       subWidth++;
@@ -69,10 +82,11 @@ Ref<BitMatrix> HybridBinarizer::getBlackMatrix() {
       subHeight++;
     }
     ArrayRef<int> blackPoints =
-      calculateBlackPoints(luminances, subWidth, subHeight, width, height);
+      calculateBlackPoints(luminances, stride, subWidth, subHeight, width, height);
 
     Ref<BitMatrix> newMatrix (new BitMatrix(width, height));
     calculateThresholdForBlock(luminances,
+                               stride,
                                subWidth,
                                subHeight,
                                width,
@@ -93,63 +107,102 @@ namespace {
   }
 }
 
+/**
+ * Each block is thresholded at the average black point of the 5x5 blocks around it (moved inwards
+ * at the edges), read from a summed-area table of the black points, and the matrix is then filled
+ * a row at a time.
+ */
 void
-HybridBinarizer::calculateThresholdForBlock(ArrayRef<byte> luminances,
+HybridBinarizer::calculateThresholdForBlock(const byte* luminances,
+                                            int stride,
                                             int subWidth,
                                             int subHeight,
                                             int width,
                                             int height,
                                             ArrayRef<int> blackPoints,
                                             Ref<BitMatrix> const& matrix) {
+  // table[y * tableWidth + x] is the sum of the black points of the blocks above and left of (x, y)
+  const int tableWidth = subWidth + 1;
+  vector<int> table(tableWidth * (subHeight + 1), 0);
+  for (int y = 0; y < subHeight; y++) {
+    int rowSum = 0;
+    for (int x = 0; x < subWidth; x++) {
+      rowSum += blackPoints[y * subWidth + x];
+      table[(y + 1) * tableWidth + x + 1] = table[y * tableWidth + x + 1] + rowSum;
+    }
+  }
+
+  vector<byte> thresholds(subWidth);
+  int maxYOffset = height - BLOCK_SIZE;
   for (int y = 0; y < subHeight; y++) {
     int yoffset = y << BLOCK_SIZE_POWER;
-    int maxYOffset = height - BLOCK_SIZE;
     if (yoffset > maxYOffset) {
       yoffset = maxYOffset;
     }
+    int top = cap(y, 2, subHeight - 3);
+    const int* above = &table[(top - 2) * tableWidth];
+    const int* below = &table[(top + 3) * tableWidth];
     for (int x = 0; x < subWidth; x++) {
-      int xoffset = x << BLOCK_SIZE_POWER;
-      int maxXOffset = width - BLOCK_SIZE;
-      if (xoffset > maxXOffset) {
-        xoffset = maxXOffset;
-      }
       int left = cap(x, 2, subWidth - 3);
-      int top = cap(y, 2, subHeight - 3);
-      int sum = 0;
-      for (int z = -2; z <= 2; z++) {
-        int *blackRow = &blackPoints[(top + z) * subWidth];
-        sum += blackRow[left - 2];
-        sum += blackRow[left - 1];
-        sum += blackRow[left];
-        sum += blackRow[left + 1];
-        sum += blackRow[left + 2];
-      }
-      int average = sum / 25;
-      thresholdBlock(luminances, xoffset, yoffset, average, width, matrix);
+      int sum = below[left + 3] - below[left - 2] - above[left + 3] + above[left - 2];
+      thresholds[x] = (byte) (sum / 25);
+    }
+    for (int yy = 0; yy < BLOCK_SIZE; yy++) {
+      thresholdRow(luminances + (yoffset + yy) * stride, &thresholds[0], subWidth, width,
+                   matrix->getRowWords(yoffset + yy));
     }
   }
 }
 
-void HybridBinarizer::thresholdBlock(ArrayRef<byte> luminances,
-                                     int xoffset,
-                                     int yoffset,
-                                     int threshold,
-                                     int stride,
-                                     Ref<BitMatrix> const& matrix) {
-  for (int y = 0, offset = yoffset * stride + xoffset;
-       y < BLOCK_SIZE;
-       y++,  offset += stride) {
-    for (int x = 0; x < BLOCK_SIZE; x++) {
-      int pixel = luminances[offset + x] & 0xff;
-      if (pixel <= threshold) {
-        matrix->set(xoffset + x, yoffset + y);
-      }
+/**
+ * Sets the bits of one row whose pixels are at or below the threshold of their block. Whole blocks
+ * go two at a time with SSE2. When the width is not a multiple of the block size the last block is
+ * moved left to end at the edge, so it overlaps the one before it and only adds bits, as the last
+ * row of blocks does for the rows it shares.
+ */
+void HybridBinarizer::thresholdRow(const byte* luminances,
+                                   const byte* thresholds,
+                                   int subWidth,
+                                   int width,
+                                   BitMatrix::Word* words) {
+  typedef BitMatrix::Word Word;
+  int x = 0;
+#ifdef HB_SSE2
+  int wholeBlocks = width >> BLOCK_SIZE_POWER;
+  for (; x + 2 <= wholeBlocks; x += 2) {
+    int xoffset = x << BLOCK_SIZE_POWER;
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luminances + xoffset));
+    __m128i threshold = _mm_unpacklo_epi64(_mm_set1_epi8((char) thresholds[x]),
+                                           _mm_set1_epi8((char) thresholds[x + 1]));
+    // pixel <= threshold exactly when min(pixel, threshold) == pixel
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(pixels, threshold), pixels));
+    words[xoffset >> 6] |= (Word) mask << (xoffset & 63);
+  }
+#endif
+  int maxXOffset = width - BLOCK_SIZE;
+  for (; x < subWidth; x++) {
+    int xoffset = x << BLOCK_SIZE_POWER;
+    if (xoffset > maxXOffset) {
+      xoffset = maxXOffset;
+    }
+    int threshold = thresholds[x];
+    unsigned int mask = 0;
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+      mask |= (unsigned int) (luminances[xoffset + i] <= threshold) << i;
+    }
+    int shift = xoffset & 63;
+    words[xoffset >> 6] |= (Word) mask << shift;
+    // only a block that was moved left can straddle two words
+    if (shift > 64 - BLOCK_SIZE) {
+      words[(xoffset >> 6) + 1] |= (Word) mask >> (64 - shift);
     }
   }
 }
 
 namespace {
-  inline int getBlackPointFromNeighbors(ArrayRef<int> blackPoints, int subWidth, int x, int y) {
+  // called for every low contrast block, so the array is not copied: that would be two atomic
+  // reference count updates per block
+  inline int getBlackPointFromNeighbors(ArrayRef<int> const& blackPoints, int subWidth, int x, int y) {
     return (blackPoints[(y-1)*subWidth+x] +
             2*blackPoints[y*subWidth+x-1] +
             blackPoints[(y-1)*subWidth+x-1]) >> 2;
@@ -157,7 +210,13 @@ namespace {
 }
 
 
-ArrayRef<int> HybridBinarizer::calculateBlackPoints(ArrayRef<byte> luminances,
+/**
+ * The black point of each block is its average, or for a block with too little contrast to tell,
+ * half its minimum raised to what its neighbours suggest. Sums, minimums and maximums are gathered
+ * for a whole row of blocks first, two blocks at a time with SSE2.
+ */
+ArrayRef<int> HybridBinarizer::calculateBlackPoints(const byte* luminances,
+                                                    int stride,
                                                     int subWidth,
                                                     int subHeight,
                                                     int width,
@@ -165,55 +224,77 @@ ArrayRef<int> HybridBinarizer::calculateBlackPoints(ArrayRef<byte> luminances,
   const int minDynamicRange = 24;
 
   ArrayRef<int> blackPoints (subHeight * subWidth);
+  vector<int> sums(subWidth), mins(subWidth), maxes(subWidth);
+  int maxXOffset = width - BLOCK_SIZE;
+  int maxYOffset = height - BLOCK_SIZE;
   for (int y = 0; y < subHeight; y++) {
     int yoffset = y << BLOCK_SIZE_POWER;
-    int maxYOffset = height - BLOCK_SIZE;
     if (yoffset > maxYOffset) {
       yoffset = maxYOffset;
     }
-    for (int x = 0; x < subWidth; x++) {
+    const byte* blockRow = luminances + yoffset * stride;
+    int x = 0;
+#ifdef HB_SSE2
+    // the sum of absolute differences from zero adds up each 8 byte half of a load on its own
+    const __m128i zero = _mm_setzero_si128();
+    int wholeBlocks = width >> BLOCK_SIZE_POWER;
+    for (; x + 2 <= wholeBlocks; x += 2) {
+      const byte* pixels = blockRow + (x << BLOCK_SIZE_POWER);
+      __m128i sum = zero;
+      __m128i min = _mm_set1_epi8((char) 0xFF);
+      __m128i max = zero;
+      for (int yy = 0; yy < BLOCK_SIZE; yy++, pixels += stride) {
+        __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(row, zero));
+        min = _mm_min_epu8(min, row);
+        max = _mm_max_epu8(max, row);
+      }
+      // fold each half down to its lowest byte
+      min = _mm_min_epu8(min, _mm_srli_epi64(min, 32));
+      min = _mm_min_epu8(min, _mm_srli_epi64(min, 16));
+      min = _mm_min_epu8(min, _mm_srli_epi64(min, 8));
+      max = _mm_max_epu8(max, _mm_srli_epi64(max, 32));
+      max = _mm_max_epu8(max, _mm_srli_epi64(max, 16));
+      max = _mm_max_epu8(max, _mm_srli_epi64(max, 8));
+      sums[x] = _mm_cvtsi128_si32(sum);
+      sums[x + 1] = _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+      mins[x] = _mm_cvtsi128_si32(min) & 0xFF;
+      mins[x + 1] = _mm_cvtsi128_si32(_mm_srli_si128(min, 8)) & 0xFF;
+      maxes[x] = _mm_cvtsi128_si32(max) & 0xFF;
+      maxes[x + 1] = _mm_cvtsi128_si32(_mm_srli_si128(max, 8)) & 0xFF;
+    }
+#endif
+    for (; x < subWidth; x++) {
       int xoffset = x << BLOCK_SIZE_POWER;
-      int maxXOffset = width - BLOCK_SIZE;
       if (xoffset > maxXOffset) {
         xoffset = maxXOffset;
       }
       int sum = 0;
       int min = 0xFF;
       int max = 0;
-      for (int yy = 0, offset = yoffset * width + xoffset;
-           yy < BLOCK_SIZE;
-           yy++, offset += width) {
+      const byte* pixels = blockRow + xoffset;
+      for (int yy = 0; yy < BLOCK_SIZE; yy++, pixels += stride) {
         for (int xx = 0; xx < BLOCK_SIZE; xx++) {
-          int pixel = luminances[offset + xx] & 0xFF;
+          int pixel = pixels[xx];
           sum += pixel;
-          // still looking for good contrast
-          if (pixel < min) {
-            min = pixel;
-          }
-          if (pixel > max) {
-            max = pixel;
-          }
-        }
-
-        // short-circuit min/max tests once dynamic range is met
-        if (max - min > minDynamicRange) {
-          // finish the rest of the rows quickly
-          for (yy++, offset += width; yy < BLOCK_SIZE; yy++, offset += width) {
-            for (int xx = 0; xx < BLOCK_SIZE; xx += 2) {
-              sum += luminances[offset + xx] & 0xFF;
-              sum += luminances[offset + xx + 1] & 0xFF;
-            }
-          }
+          min = pixel < min ? pixel : min;
+          max = pixel > max ? pixel : max;
         }
       }
+      sums[x] = sum;
+      mins[x] = min;
+      maxes[x] = max;
+    }
+
+    for (x = 0; x < subWidth; x++) {
       // See
       // http://groups.google.com/group/zxing/browse_thread/thread/d06efa2c35a7ddc0
-      int average = sum >> (BLOCK_SIZE_POWER * 2);
-      if (max - min <= minDynamicRange) {
-        average = min >> 1;
+      int average = sums[x] >> (BLOCK_SIZE_POWER * 2);
+      if (maxes[x] - mins[x] <= minDynamicRange) {
+        average = mins[x] >> 1;
         if (y > 0 && x > 0) {
           int bp = getBlackPointFromNeighbors(blackPoints, subWidth, x, y);
-          if (min < bp) {
+          if (mins[x] < bp) {
             average = bp;
           }
         }
@@ -223,4 +304,3 @@ ArrayRef<int> HybridBinarizer::calculateBlackPoints(ArrayRef<byte> luminances,
   }
   return blackPoints;
 }
-
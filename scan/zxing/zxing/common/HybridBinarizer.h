@@ -42,24 +42,25 @@ namespace zxing {
   private:
     // We'll be using one-D arrays because C++ can't dynamically allocate 2D
     // arrays
-    ArrayRef<int> calculateBlackPoints(ArrayRef<byte> luminances,
+    ArrayRef<int> calculateBlackPoints(const byte* luminances,
+                                       int stride,
                                        int subWidth,
                                        int subHeight,
                                        int width,
                                        int height);
-    void calculateThresholdForBlock(ArrayRef<byte> luminances,
+    void calculateThresholdForBlock(const byte* luminances,
+                                    int stride,
                                     int subWidth,
                                     int subHeight,
                                     int width,
                                     int height,
                                     ArrayRef<int> blackPoints,
                                     Ref<BitMatrix> const& matrix);
-    void thresholdBlock(ArrayRef<byte>luminances,
-                        int xoffset,
-                        int yoffset,
-                        int threshold,
-                        int stride,
-                        Ref<BitMatrix> const& matrix);
+    void thresholdRow(const byte* luminances,
+                      const byte* thresholds,
+                      int subWidth,
+                      int width,
+                      BitMatrix::Word* words);
 	};
 
 }
@@ -86,7 +86,7 @@ Ref<PerspectiveTransform> PerspectiveTransform::times(Ref<PerspectiveTransform>
   return result;
 }
 
-void PerspectiveTransform::transformPoints(vector<float> &points) {
+void PerspectiveTransform::transformPoints(ArenaVector<float> &points) {
   int max = points.size();
   for (int i = 0; i < max; i += 2) {
     float x = points[i];
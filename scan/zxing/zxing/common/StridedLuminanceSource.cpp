@@ -0,0 +1,82 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  StridedLuminanceSource.cpp
+ *  zxing
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/StridedLuminanceSource.h>
+#include <zxing/common/GreyscaleLuminanceSource.h>
+#include <zxing/common/IllegalArgumentException.h>
+#include <cstring>
+
+using zxing::Ref;
+using zxing::ArrayRef;
+using zxing::LuminanceSource;
+
+namespace zxing {
+
+StridedLuminanceSource::StridedLuminanceSource(const byte* data, int width, int height, int stride)
+    : Super(width, height), data_(data), stride_(stride) {
+  if (stride < width) {
+    throw IllegalArgumentException("Stride is narrower than the image.");
+  }
+}
+
+ArrayRef<byte> StridedLuminanceSource::getRow(int y, ArrayRef<byte> row) const {
+  if (y < 0 || y >= getHeight()) {
+    throw IllegalArgumentException("Requested row is outside the image.");
+  }
+  int width = getWidth();
+  if (!row || row->size() < width) {
+    row = ArrayRef<byte>(width);
+  }
+  memcpy(&row[0], data_ + y * stride_, width);
+  return row;
+}
+
+ArrayRef<byte> StridedLuminanceSource::getMatrix() const {
+  int width = getWidth();
+  int height = getHeight();
+  ArrayRef<byte> result (width * height);
+  if (stride_ == width) {
+    memcpy(&result[0], data_, width * height);
+  } else {
+    for (int y = 0; y < height; y++) {
+      memcpy(&result[y * width], data_ + y * stride_, width);
+    }
+  }
+  return result;
+}
+
+const byte* StridedLuminanceSource::getPlane(int& stride) const {
+  stride = stride_;
+  return data_;
+}
+
+Ref<LuminanceSource> StridedLuminanceSource::crop(int left, int top, int width, int height) const {
+  if (left < 0 || top < 0 || left + width > getWidth() || top + height > getHeight()) {
+    throw IllegalArgumentException("Crop rectangle does not fit within image data.");
+  }
+  return Ref<LuminanceSource>(new StridedLuminanceSource(data_ + top * stride_ + left, width, height, stride_));
+}
+
+Ref<LuminanceSource> StridedLuminanceSource::rotateCounterClockwise() const {
+  // rotation needs a buffer that outlives this call, so this (rare) path copies
+  Ref<GreyscaleLuminanceSource> owned (
+      new GreyscaleLuminanceSource(getMatrix(), getWidth(), getHeight(), 0, 0, getWidth(), getHeight()));
+  return owned->rotateCounterClockwise();
+}
+
+}
@@ -0,0 +1,58 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __STRIDED_LUMINANCE_SOURCE__
+#define __STRIDED_LUMINANCE_SOURCE__
+/*
+ *  StridedLuminanceSource.h
+ *  zxing
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/LuminanceSource.h>
+
+namespace zxing {
+
+/*
+ * Wraps an 8-bit luminance plane owned by someone else (a Grayscale8 image,
+ * the Y plane of a YUV video frame, ...) without copying it. The buffer must
+ * stay valid and unchanged for as long as the source, or anything cropped
+ * from it, is in use -- typically for one synchronous decode call.
+ */
+class StridedLuminanceSource : public LuminanceSource {
+
+private:
+  typedef LuminanceSource Super;
+  const byte* data_;
+  const int stride_;
+
+public:
+  StridedLuminanceSource(const byte* data, int width, int height, int stride);
+
+  ArrayRef<byte> getRow(int y, ArrayRef<byte> row) const;
+  ArrayRef<byte> getMatrix() const;
+  const byte* getPlane(int& stride) const;
+
+  bool isCropSupported() const {
+    return true;
+  }
+  Ref<LuminanceSource> crop(int left, int top, int width, int height) const;
+
+  bool isRotateSupported() const {
+    return true;
+  }
+  Ref<LuminanceSource> rotateCounterClockwise() const;
+};
+
+}
+
+#endif
@@ -37,15 +37,11 @@ Ref<GenericGF> GenericGF::DATA_MATRIX_FIELD_256(new GenericGF(0x012D, 256, 1));
 Ref<GenericGF> GenericGF::AZTEC_DATA_8 = DATA_MATRIX_FIELD_256;
 Ref<GenericGF> GenericGF::MAXICODE_FIELD_64 = AZTEC_DATA_6;
   
-namespace {
-  int INITIALIZATION_THRESHOLD = 0;
-}
-  
+// The tables are built up front rather than on first use: the fields are shared by every
+// decoder, on whatever thread it runs, and are only ever read after construction.
 GenericGF::GenericGF(int primitive_, int size_, int b)
-  : size(size_), primitive(primitive_), generatorBase(b), initialized(false) {
-  if (size <= INITIALIZATION_THRESHOLD) {
-    initialize();
-  }
+  : size(size_), primitive(primitive_), generatorBase(b) {
+  initialize();
 }
   
 void GenericGF::initialize() {
@@ -65,6 +61,15 @@ void GenericGF::initialize() {
   for (int i = 0; i < size-1; i++) {
     logTable[expTable[i]] = i;
   }
+  // 64 KiB buys ReedSolomonDecoder a branch-free multiply for the QR and Data Matrix fields
+  if (size == 256) {
+    multiplyTable = std::vector<unsigned char>(size * size);
+    for (int a = 1; a < size; a++) {
+      for (int b = 1; b < size; b++) {
+        multiplyTable[a << 8 | b] = (unsigned char) expTable[(logTable[a] + logTable[b]) % (size - 1)];
+      }
+    }
+  }
   //logTable[0] == 0 but this should never be used
   ArrayRef<int> coefficients_zero(1);
   ArrayRef<int> coefficients_one(1);
@@ -74,28 +79,17 @@ void GenericGF::initialize() {
 
   zero = Ref<GenericGFPoly>(new GenericGFPoly(this, coefficients_zero));
   one = Ref<GenericGFPoly>(new GenericGFPoly(this, coefficients_one));
-  initialized = true;
-}
-  
-void GenericGF::checkInit() {
-  if (!initialized) {
-    initialize();
-  }
 }
   
 Ref<GenericGFPoly> GenericGF::getZero() {
-  checkInit();
   return zero;
 }
   
 Ref<GenericGFPoly> GenericGF::getOne() {
-  checkInit();
   return one;
 }
   
 Ref<GenericGFPoly> GenericGF::buildMonomial(int degree, int coefficient) {
-  checkInit();
-    
   if (degree < 0) {
     throw IllegalArgumentException("Degree must be non-negative");
   }
@@ -113,12 +107,10 @@ int GenericGF::addOrSubtract(int a, int b) {
 }
   
 int GenericGF::exp(int a) {
-  checkInit();
   return expTable[a];
 }
   
 int GenericGF::log(int a) {
-  checkInit();
   if (a == 0) {
     throw IllegalArgumentException("cannot give log(0)");
   }
@@ -126,7 +118,6 @@ int GenericGF::log(int a) {
 }
   
 int GenericGF::inverse(int a) {
-  checkInit();
   if (a == 0) {
     throw IllegalArgumentException("Cannot calculate the inverse of 0");
   }
@@ -134,8 +125,6 @@ int GenericGF::inverse(int a) {
 }
   
 int GenericGF::multiply(int a, int b) {
-  checkInit();
-    
   if (a == 0 || b == 0) {
     return 0;
   }
@@ -150,3 +139,7 @@ int GenericGF::getSize() {
 int GenericGF::getGeneratorBase() {
   return generatorBase;
 }
+
+const unsigned char* GenericGF::getMultiplyTable() const {
+  return multiplyTable.empty() ? 0 : &multiplyTable[0];
+}
@@ -33,15 +33,15 @@ namespace zxing {
   private:
     std::vector<int> expTable;
     std::vector<int> logTable;
+    // GF(256) only: the product of a and b at [a << 8 | b]
+    std::vector<unsigned char> multiplyTable;
     Ref<GenericGFPoly> zero;
     Ref<GenericGFPoly> one;
     int size;
     int primitive;
     int generatorBase;
-    bool initialized;
     
     void initialize();
-    void checkInit();
     
   public:
     static Ref<GenericGF> AZTEC_DATA_12;
@@ -59,6 +59,8 @@ namespace zxing {
     Ref<GenericGFPoly> getOne();
     int getSize();
     int getGeneratorBase();
+    // 0 unless the field is GF(256)
+    const unsigned char* getMultiplyTable() const;
     Ref<GenericGFPoly> buildMonomial(int degree, int coefficient);
     
     static int addOrSubtract(int a, int b);
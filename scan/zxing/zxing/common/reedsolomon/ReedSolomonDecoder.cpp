@@ -19,6 +19,7 @@
 #include <iostream>
 
 #include <memory>
+#include <cstring>
 #include <zxing/common/reedsolomon/ReedSolomonDecoder.h>
 #include <zxing/common/reedsolomon/ReedSolomonException.h>
 #include <zxing/common/IllegalArgumentException.h>
@@ -39,7 +40,18 @@ ReedSolomonDecoder::ReedSolomonDecoder(Ref<GenericGF> field_) : field(field_) {}
 ReedSolomonDecoder::~ReedSolomonDecoder() {
 }
 
+namespace {
+  // longest block of a GF(256) code, and so the most syndromes it can have
+  const int GF256_MAX_CODEWORDS = 255;
+}
+
 void ReedSolomonDecoder::decode(ArrayRef<int> received, int twoS) {
+  const unsigned char* multiply = field->getMultiplyTable();
+  if (multiply && received->size() <= GF256_MAX_CODEWORDS && twoS > 0 && twoS <= received->size()) {
+    decodeGF256(received, twoS, multiply, 0, 0);
+    return;
+  }
+
   Ref<GenericGFPoly> poly(new GenericGFPoly(field, received));
   ArrayRef<int> syndromeCoefficients(twoS);
   bool noError = true;
@@ -69,6 +81,156 @@ void ReedSolomonDecoder::decode(ArrayRef<int> received, int twoS) {
   }
 }
 
+// The QR and Data Matrix fields, without a single polynomial object: syndromes, then
+// Berlekamp-Massey for the error locator, Chien search over the positions of the block and
+// Forney for the magnitudes, all in arrays on the stack and with table lookups for products.
+// Erasures seed the locator with their known roots, and Berlekamp-Massey carries on from there.
+int ReedSolomonDecoder::decodeGF256(ArrayRef<int> received, int twoS, const unsigned char* multiply,
+                                     const int* erasures, int numErasures) {
+  const int n = received->size();
+  const int base = field->getGeneratorBase();
+
+  // S_i = r(alpha^(base + i)); every codeword goes into all of them at once (Horner's rule), so
+  // the syndromes are independent chains of lookups rather than one long one
+  unsigned char syndromes[GF256_MAX_CODEWORDS];
+  const unsigned char* alphaRows[GF256_MAX_CODEWORDS];
+  for (int i = 0; i < twoS; i++) {
+    syndromes[i] = 0;
+    alphaRows[i] = multiply + (field->exp(i + base) << 8);
+  }
+  for (int j = 0; j < n; j++) {
+    const unsigned char c = (unsigned char) received[j];
+    for (int i = 0; i < twoS; i++) {
+      syndromes[i] = alphaRows[i][syndromes[i]] ^ c;
+    }
+  }
+  unsigned char any = 0;
+  for (int i = 0; i < twoS; i++) {
+    any |= syndromes[i];
+  }
+  if (!any) {
+    return 0;
+  }
+
+  // the erasure locator, the product of (1 - X x) over the erased positions
+  unsigned char lambda[GF256_MAX_CODEWORDS + 1] = { 1 };
+  for (int e = 0; e < numErasures; e++) {
+    const int position = erasures[e];
+    if (position < 0 || position >= n) {
+      throw IllegalArgumentException("Erasure outside the block");
+    }
+    const unsigned char* byX = multiply + (field->exp(n - 1 - position) << 8);
+    for (int i = e + 1; i >= 1; i--) {
+      lambda[i] ^= byX[lambda[i - 1]];
+    }
+  }
+
+  // Berlekamp-Massey: the shortest lambda with lambda(x) S(x) free of x^L..x^(twoS-1)
+  unsigned char previous[GF256_MAX_CODEWORDS + 1];
+  unsigned char saved[GF256_MAX_CODEWORDS + 1];
+  memcpy(previous, lambda, sizeof(previous));
+  int L = numErasures;
+  int shift = 1;
+  unsigned char previousDiscrepancy = 1;
+  for (int k = numErasures; k < twoS; k++) {
+    unsigned char d = syndromes[k];
+    for (int i = 1; i <= L; i++) {
+      d ^= multiply[lambda[i] << 8 | syndromes[k - i]];
+    }
+    if (d == 0) {
+      shift++;
+      continue;
+    }
+    const unsigned char* scale = multiply + (multiply[d << 8 | field->inverse(previousDiscrepancy)] << 8);
+    const bool grow = 2 * L <= k + numErasures;
+    if (grow) {
+      memcpy(saved, lambda, twoS + 1);
+    }
+    for (int i = 0; i + shift <= twoS; i++) {
+      lambda[i + shift] ^= scale[previous[i]];
+    }
+    if (grow) {
+      L = k + 1 + numErasures - L;
+      memcpy(previous, saved, twoS + 1);
+      previousDiscrepancy = d;
+      shift = 1;
+    } else {
+      shift++;
+    }
+  }
+  // erasures count once against twoS, errors twice
+  if (2 * L - numErasures > twoS) {
+    throw ReedSolomonException("Too many errors");
+  }
+
+  // omega = S lambda mod x^L, the error evaluator
+  unsigned char omega[GF256_MAX_CODEWORDS];
+  for (int i = 0; i < L; i++) {
+    unsigned char v = 0;
+    for (int j = 0; j <= i; j++) {
+      v ^= multiply[lambda[j] << 8 | syndromes[i - j]];
+    }
+    omega[i] = v;
+  }
+
+  // Chien: position p of the block has locator X = alpha^(n - 1 - p) and is in error when
+  // lambda(1/X) = 0; then Forney: e = X^(1 - base) omega(1/X) / lambda'(1/X). Nothing is
+  // corrected until all L are found, so a block that can't be decoded is left as it was.
+  int positions[GF256_MAX_CODEWORDS];
+  unsigned char magnitudes[GF256_MAX_CODEWORDS];
+  int found = 0;
+  for (int p = 0; p < n && found < L; p++) {
+    const int power = n - 1 - p;
+    const unsigned char* byXInverse = multiply + (field->exp((255 - power) % 255) << 8);
+    unsigned char value = lambda[L];
+    for (int i = L - 1; i >= 0; i--) {
+      value = byXInverse[value] ^ lambda[i];
+    }
+    if (value != 0) {
+      continue;
+    }
+    const unsigned char xInverse = byXInverse[1];
+    unsigned char evaluator = 0;
+    for (int i = L - 1; i >= 0; i--) {
+      evaluator = byXInverse[evaluator] ^ omega[i];
+    }
+    // in characteristic 2 only the odd terms of lambda survive differentiation
+    const unsigned char* byXInverseSquared = multiply + (byXInverse[xInverse] << 8);
+    unsigned char derivative = 0;
+    for (int i = (L - 1) | 1; i >= 1; i -= 2) {
+      derivative = byXInverseSquared[derivative] ^ lambda[i];
+    }
+    if (derivative == 0) {
+      throw ReedSolomonException("Repeated root of the error locator");
+    }
+    int magnitude = multiply[evaluator << 8 | field->inverse(derivative)];
+    if (base != 1) {
+      magnitude = multiply[magnitude << 8 | field->exp((power * (1 - base) % 255 + 255) % 255)];
+    }
+    positions[found] = p;
+    magnitudes[found] = (unsigned char) magnitude;
+    found++;
+  }
+  if (found != L) {
+    throw ReedSolomonException("Error locator degree does not match number of roots");
+  }
+  for (int i = 0; i < found; i++) {
+    received[positions[i]] ^= magnitudes[i];
+  }
+  return L - numErasures;
+}
+
+int ReedSolomonDecoder::decodeWithErasures(ArrayRef<int> received, int twoS, const ArenaVector<int>& erasures) {
+  const unsigned char* multiply = field->getMultiplyTable();
+  if (!multiply || received->size() > GF256_MAX_CODEWORDS || twoS <= 0 || twoS > received->size()) {
+    throw IllegalArgumentException("Erasures need a GF(256) block");
+  }
+  if ((int) erasures.size() > twoS) {
+    throw ReedSolomonException("Too many erasures");
+  }
+  return decodeGF256(received, twoS, multiply, erasures.empty() ? 0 : &erasures[0], erasures.size());
+}
+
 vector<Ref<GenericGFPoly> > ReedSolomonDecoder::runEuclideanAlgorithm(Ref<GenericGFPoly> a,
                                                                       Ref<GenericGFPoly> b,
                                                                       int R) {
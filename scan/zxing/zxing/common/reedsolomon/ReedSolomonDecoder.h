@@ -38,9 +38,15 @@ public:
   ReedSolomonDecoder(Ref<GenericGF> fld);
   ~ReedSolomonDecoder();
   void decode(ArrayRef<int> received, int twoS);
+  // As decode(), but the codewords at the given positions are erasures: values not to be trusted,
+  // which cost one of the twoS error correction codewords each instead of two. Returns the number
+  // of errors found outside them. Only for GF(256) fields.
+  int decodeWithErasures(ArrayRef<int> received, int twoS, const ArenaVector<int>& erasures);
   std::vector<Ref<GenericGFPoly> > runEuclideanAlgorithm(Ref<GenericGFPoly> a, Ref<GenericGFPoly> b, int R);
 
 private:
+  int decodeGF256(ArrayRef<int> received, int twoS, const unsigned char* multiply,
+                  const int* erasures, int numErasures);
   ArrayRef<int> findErrorLocations(Ref<GenericGFPoly> errorLocator);
   ArrayRef<int> findErrorMagnitudes(Ref<GenericGFPoly> errorEvaluator, ArrayRef<int> errorLocations);
 };
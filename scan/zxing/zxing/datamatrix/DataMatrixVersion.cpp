@@ -121,7 +121,8 @@ Ref<Version> Version::getVersionForDimensions(int numRows, int numColumns) {
     // If we interleave the rectangular versions with the square versions we could
     // do a binary search.
     for (int i = 0; i < N_VERSIONS; ++i){
-      Ref<Version> version(VERSIONS[i]);
+      // by reference, so the shared table entries are not refcounted on every step
+      const Ref<Version>& version = VERSIONS[i];
       if (version->getSymbolSizeRows() == numRows && version->getSymbolSizeColumns() == numColumns) {
         return version;
       }
@@ -35,7 +35,7 @@ std::vector<Ref<Result> > QRCodeMultiReader::decodeMultiple(Ref<BinaryBitmap> im
   std::vector<Ref<DetectorResult> > detectorResult =  detector.detectMulti(hints);
   for (unsigned int i = 0; i < detectorResult.size(); i++) {
     try {
-      Ref<DecoderResult> decoderResult = getDecoder().decode(detectorResult[i]->getBits());
+      Ref<DecoderResult> decoderResult = getDecoder().decode(detectorResult[i]->getBits(), detectorResult[i]->getDoubtful());
       ArrayRef< Ref<ResultPoint> > points = detectorResult[i]->getPoints();
       Ref<Result> result = Ref<Result>(new Result(decoderResult->getText(),
       decoderResult->getRawBytes(), 
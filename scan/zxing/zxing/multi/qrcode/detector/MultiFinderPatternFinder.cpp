@@ -79,28 +79,38 @@ vector<Ref<FinderPatternInfo> > MultiFinderPatternFinder::findMulti(DecodeHints
 
   int stateCount[5];
   for (int i = iSkip - 1; i < maxI; i += iSkip) {
-    // Get a row of black/white values
+    // Get a row of black/white values, as the lengths of its runs starting with white
+    image->getRowRuns(i, scanRuns_);
     stateCount[0] = 0;
     stateCount[1] = 0;
     stateCount[2] = 0;
     stateCount[3] = 0;
     stateCount[4] = 0;
     int currentState = 0;
-    for (int j = 0; j < maxJ; j++) {
-      if (image->get(j, i)) {
-        // Black pixel
+    int j = 0;
+    for (size_t run = 0; run < scanRuns_.size(); run++) {
+      int length = scanRuns_[run];
+      // the first pixel of the run
+      int start = j;
+      j += length;
+      if (length == 0) {
+        continue;
+      }
+      if ((run & 1) == 1) {
+        // Black run
         if ((currentState & 1) == 1) { // Counting white pixels
           currentState++;
         }
-        stateCount[currentState]++;
-      } else { // White pixel
+        stateCount[currentState] += length;
+      } else { // White run
         if ((currentState & 1) == 0) { // Counting black pixels
           if (currentState == 4) { // A winner?
-            if (foundPatternCross(stateCount) && handlePossibleCenter(stateCount, i, j)) { // Yes
-              // Clear state to start looking again
-              currentState = 0;
+            if (foundPatternCross(stateCount) && handlePossibleCenter(stateCount, i, start)) { // Yes
+              // Clear state to start looking again; the white pixel that ended the pattern is
+              // not counted, the rest of the run is
+              currentState = length > 1 ? 1 : 0;
               stateCount[0] = 0;
-              stateCount[1] = 0;
+              stateCount[1] = length - 1;
               stateCount[2] = 0;
               stateCount[3] = 0;
               stateCount[4] = 0;
@@ -108,18 +118,18 @@ vector<Ref<FinderPatternInfo> > MultiFinderPatternFinder::findMulti(DecodeHints
               stateCount[0] = stateCount[2];
               stateCount[1] = stateCount[3];
               stateCount[2] = stateCount[4];
-              stateCount[3] = 1;
+              stateCount[3] = length;
               stateCount[4] = 0;
               currentState = 3;
             }
           } else {
-            stateCount[++currentState]++;
+            stateCount[++currentState] += length;
           }
         } else { // Counting white pixels
-          stateCount[currentState]++;
+          stateCount[currentState] += length;
         }
       }
-    } // for j=...
+    } // for run=...
 
     if (foundPatternCross(stateCount)) {
       handlePossibleCenter(stateCount, i, maxJ);
@@ -136,7 +146,7 @@ vector<Ref<FinderPatternInfo> > MultiFinderPatternFinder::findMulti(DecodeHints
 }
 
 vector<vector<Ref<FinderPattern> > > MultiFinderPatternFinder::selectBestPatterns(){
-  vector<Ref<FinderPattern> > possibleCenters = possibleCenters_;
+  vector<Ref<FinderPattern> > possibleCenters(possibleCenters_.begin(), possibleCenters_.end());
   
   int size = possibleCenters.size();
 
@@ -151,7 +161,7 @@ vector<vector<Ref<FinderPattern> > > MultiFinderPatternFinder::selectBestPattern
    * Begin HE modifications to safely detect multiple codes of equal size
    */
   if (size == 3) {
-    results.push_back(possibleCenters_);
+    results.push_back(possibleCenters);
     return results;
   }
 
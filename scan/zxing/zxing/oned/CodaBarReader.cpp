@@ -242,17 +242,13 @@ void CodaBarReader::setCounters(Ref<BitArray> row)  {
     throw NotFoundException();
   }
   bool isWhite = true;
-  int count = 0;
-  for (; i < end; i++) {
-    if (row->get(i) ^ isWhite) { // that is, exactly one is true
-      count++;
-    } else {
-      counterAppend(count);
-      count = 1;
-      isWhite = !isWhite;
-    }
+  while (i < end) {
+    // each run in one step
+    int runEnd = isWhite ? row->getNextSet(i) : row->getNextUnset(i);
+    counterAppend(runEnd - i);
+    i = runEnd;
+    isWhite = !isWhite;
   }
-  counterAppend(count);
 }
 
 void CodaBarReader::counterAppend(int e) {
@@ -187,42 +187,47 @@ vector<int> Code128Reader::findStartPattern(Ref<BitArray> row){
   bool isWhite = false;
   int patternLength =  counters.size();
 
-  for (int i = rowOffset; i < width; i++) {
-    if (row->get(i) ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        int bestVariance = MAX_AVG_VARIANCE;
-        int bestMatch = -1;
-        for (int startCode = CODE_START_A; startCode <= CODE_START_C; startCode++) {
-          int variance = patternMatchVariance(counters, CODE_PATTERNS[startCode], MAX_INDIVIDUAL_VARIANCE);
-          if (variance < bestVariance) {
-            bestVariance = variance;
-            bestMatch = startCode;
-          }
-        }
-        // Look for whitespace before start pattern, >= 50% of width of start pattern
-        if (bestMatch >= 0 &&
-            row->isRange(std::max(0, patternStart - (i - patternStart) / 2), patternStart, false)) {
-          vector<int> resultValue (3, 0);
-          resultValue[0] = patternStart;
-          resultValue[1] = i;
-          resultValue[2] = bestMatch;
-          return resultValue;
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
+  int i = rowOffset;
+  while (i < width) {
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(i) : row->getNextUnset(i);
+    counters[counterPosition] += runEnd - i;
+    i = runEnd;
+    if (i == width) {
+      break;
+    }
+    if (counterPosition == patternLength - 1) {
+      int bestVariance = MAX_AVG_VARIANCE;
+      int bestMatch = -1;
+      for (int startCode = CODE_START_A; startCode <= CODE_START_C; startCode++) {
+        int variance = patternMatchVariance(counters, CODE_PATTERNS[startCode], MAX_INDIVIDUAL_VARIANCE);
+        if (variance < bestVariance) {
+          bestVariance = variance;
+          bestMatch = startCode;
         }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      // Look for whitespace before start pattern, >= 50% of width of start pattern
+      if (bestMatch >= 0 &&
+          row->isRange(std::max(0, patternStart - (i - patternStart) / 2), patternStart, false)) {
+        vector<int> resultValue (3, 0);
+        resultValue[0] = patternStart;
+        resultValue[1] = i;
+        resultValue[2] = bestMatch;
+        return resultValue;
+      }
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
+      }
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = 1;
+    isWhite = !isWhite;
+    i++;
   }
   throw NotFoundException();
 }
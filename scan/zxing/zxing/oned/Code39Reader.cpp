@@ -184,33 +184,38 @@ vector<int> Code39Reader::findAsteriskPattern(Ref<BitArray> row, vector<int>& co
   bool isWhite = false;
   int patternLength = counters.size();
 
-  for (int i = rowOffset; i < width; i++) {
-    if (row->get(i) ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        // Look for whitespace before start pattern, >= 50% of width of
-        // start pattern.
-        if (toNarrowWidePattern(counters) == ASTERISK_ENCODING &&
-            row->isRange(std::max(0, patternStart - ((i - patternStart) >> 1)), patternStart, false)) {
-          vector<int> resultValue (2, 0);
-          resultValue[0] = patternStart;
-          resultValue[1] = i;
-          return resultValue;
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  int i = rowOffset;
+  while (i < width) {
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(i) : row->getNextUnset(i);
+    counters[counterPosition] += runEnd - i;
+    i = runEnd;
+    if (i == width) {
+      break;
+    }
+    if (counterPosition == patternLength - 1) {
+      // Look for whitespace before start pattern, >= 50% of width of
+      // start pattern.
+      if (toNarrowWidePattern(counters) == ASTERISK_ENCODING &&
+          row->isRange(std::max(0, patternStart - ((i - patternStart) >> 1)), patternStart, false)) {
+        vector<int> resultValue (2, 0);
+        resultValue[0] = patternStart;
+        resultValue[1] = i;
+        return resultValue;
+      }
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = 1;
+    isWhite = !isWhite;
+    i++;
   }
   throw NotFoundException();
 }
@@ -150,27 +150,32 @@ Code93Reader::Range Code93Reader::findAsteriskPattern(Ref<BitArray> row)  {
   int patternLength = theCounters.size();
 
   int counterPosition = 0;
-  for (int i = rowOffset; i < width; i++) {
-    if (row->get(i) ^ isWhite) {
-      theCounters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if (toPattern(theCounters) == ASTERISK_ENCODING) {
-          return Range(patternStart, i);
-        }
-        patternStart += theCounters[0] + theCounters[1];
-        for (int y = 2; y < patternLength; y++) {
-          theCounters[y - 2] = theCounters[y];
-        }
-        theCounters[patternLength - 2] = 0;
-        theCounters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  int i = rowOffset;
+  while (i < width) {
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(i) : row->getNextUnset(i);
+    theCounters[counterPosition] += runEnd - i;
+    i = runEnd;
+    if (i == width) {
+      break;
+    }
+    if (counterPosition == patternLength - 1) {
+      if (toPattern(theCounters) == ASTERISK_ENCODING) {
+        return Range(patternStart, i);
+      }
+      patternStart += theCounters[0] + theCounters[1];
+      for (int y = 2; y < patternLength; y++) {
+        theCounters[y - 2] = theCounters[y];
       }
-      theCounters[counterPosition] = 1;
-      isWhite = !isWhite;
+      theCounters[patternLength - 2] = 0;
+      theCounters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    theCounters[counterPosition] = 1;
+    isWhite = !isWhite;
+    i++;
   }
   throw NotFoundException();
 }
@@ -281,27 +281,32 @@ ITFReader::Range ITFReader::findGuardPattern(Ref<BitArray> row,
 
   int counterPosition = 0;
   int patternStart = rowOffset;
-  for (int x = rowOffset; x < width; x++) {
-    if (row->get(x) ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if (patternMatchVariance(counters, &pattern[0], MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
-          return Range(patternStart, x);
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  int x = rowOffset;
+  while (x < width) {
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(x) : row->getNextUnset(x);
+    counters[counterPosition] += runEnd - x;
+    x = runEnd;
+    if (x == width) {
+      break;
+    }
+    if (counterPosition == patternLength - 1) {
+      if (patternMatchVariance(counters, &pattern[0], MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
+        return Range(patternStart, x);
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
+      }
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = 1;
+    isWhite = !isWhite;
+    x++;
   }
   throw NotFoundException();
 }
@@ -86,11 +86,13 @@ Ref<Result> MultiFormatOneDReader::decodeRow(int rowNumber, Ref<BitArray> row) {
     OneDReader* reader = readers[i];
     try {
       Ref<Result> result = reader->decodeRow(rowNumber, row);
-      return result;
+      if (!result.empty()) {
+        return result;
+      }
     } catch (ReaderException const& re) {
       (void)re;
       // continue
     }
   }
-  throw NotFoundException();
+  return Ref<Result>();
 }
@@ -63,7 +63,10 @@ MultiFormatUPCEANReader::MultiFormatUPCEANReader(DecodeHints hints) : readers()
 
 Ref<Result> MultiFormatUPCEANReader::decodeRow(int rowNumber, Ref<BitArray> row) {
   // Compute this location once and reuse it on multiple implementations
-  UPCEANReader::Range startGuardPattern = UPCEANReader::findStartGuardPattern(row);
+  UPCEANReader::Range startGuardPattern;
+  if (!UPCEANReader::tryFindStartGuardPattern(row, startGuardPattern)) {
+    return Ref<Result>();
+  }
   for (int i = 0, e = readers.size(); i < e; i++) {
     Ref<UPCEANReader> reader = readers[i];
     Ref<Result> result;
@@ -111,5 +114,5 @@ Ref<Result> MultiFormatUPCEANReader::decodeRow(int rowNumber, Ref<BitArray> row)
     return result;
   }
 
-  throw NotFoundException();
+  return Ref<Result>();
 }
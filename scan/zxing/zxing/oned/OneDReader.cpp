@@ -38,31 +38,39 @@ using zxing::DecodeHints;
 OneDReader::OneDReader() {}
 
 Ref<Result> OneDReader::decode(Ref<BinaryBitmap> image, DecodeHints hints) {
-  try {
-    return doDecode(image, hints);
-  } catch (NotFoundException const& nfe) {
-    // std::cerr << "trying harder" << std::endl;
-    bool tryHarder = hints.getTryHarder();
-    if (tryHarder && image->isRotateSupported()) {
-      // std::cerr << "v rotate" << std::endl;
-      Ref<BinaryBitmap> rotatedImage(image->rotateCounterClockwise());
-      // std::cerr << "^ rotate" << std::endl;
-      Ref<Result> result = doDecode(rotatedImage, hints);
-      // Doesn't have java metadata stuff
-      ArrayRef< Ref<ResultPoint> >& points (result->getResultPoints());
-      if (points && !points->empty()) {
-        int height = rotatedImage->getHeight();
-        for (int i = 0; i < points->size(); i++) {
-          points[i].reset(new OneDResultPoint(height - points[i]->getY() - 1, points[i]->getX()));
-        }
-      }
-      // std::cerr << "tried harder" << std::endl;
+  Ref<Result> result = tryDecode(image, hints);
+  if (result.empty()) {
+    throw NotFoundException();
+  }
+  return result;
+}
+
+Ref<Result> OneDReader::tryDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
+  Ref<Result> result = doDecode(image, hints);
+  if (!result.empty()) {
+    return result;
+  }
+  // std::cerr << "trying harder" << std::endl;
+  bool tryHarder = hints.getTryHarder();
+  if (tryHarder && image->isRotateSupported()) {
+    // std::cerr << "v rotate" << std::endl;
+    Ref<BinaryBitmap> rotatedImage(image->rotateCounterClockwise());
+    // std::cerr << "^ rotate" << std::endl;
+    result = doDecode(rotatedImage, hints);
+    if (result.empty()) {
       return result;
-    } else {
-      // std::cerr << "tried harder nfe" << std::endl;
-      throw nfe;
     }
+    // Doesn't have java metadata stuff
+    ArrayRef< Ref<ResultPoint> >& points (result->getResultPoints());
+    if (points && !points->empty()) {
+      int height = rotatedImage->getHeight();
+      for (int i = 0; i < points->size(); i++) {
+        points[i].reset(new OneDResultPoint(height - points[i]->getY() - 1, points[i]->getX()));
+      }
+    }
+    // std::cerr << "tried harder" << std::endl;
   }
+  return result;
 }
 
 #include <typeinfo>
@@ -106,12 +114,11 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
     }
 
     // Estimate black point for this row and load it:
-    try {
-      row = image->getBlackRow(rowNumber, row);
-    } catch (NotFoundException const& ignored) {
-      (void)ignored;
+    Ref<BitArray> blackRow = image->tryGetBlackRow(rowNumber, row);
+    if (blackRow.empty()) {
       continue;
     }
+    row = blackRow;
 
     // While we have the image data in a BitArray, it's fairly cheap to reverse it in place to
     // handle decoding upside down barcodes.
@@ -126,6 +133,9 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
         // Look for a barcode
         // std::cerr << "rn " << rowNumber << " " << typeid(*this).name() << std::endl;
         Ref<Result> result = decodeRow(rowNumber, row);
+        if (result.empty()) {
+          continue;
+        }
         // We found our barcode
         if (attempt == 1) {
           // But it was upside down, so note that
@@ -147,7 +157,7 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
       }
     }
   }
-  throw NotFoundException();
+  return Ref<Result>();
 }
 
 int OneDReader::patternMatchVariance(vector<int>& counters,
@@ -205,16 +215,19 @@ void OneDReader::recordPattern(Ref<BitArray> row,
   int counterPosition = 0;
   int i = start;
   while (i < end) {
-    if (row->get(i) ^ isWhite) { // that is, exactly one is true
-      counters[counterPosition]++;
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(i) : row->getNextUnset(i);
+    counters[counterPosition] += runEnd - i;
+    i = runEnd;
+    if (i == end) {
+      break;
+    }
+    counterPosition++;
+    if (counterPosition == numCounters) {
+      break;
     } else {
-      counterPosition++;
-      if (counterPosition == numCounters) {
-        break;
-      } else {
-        counters[counterPosition] = 1;
-        isWhite = !isWhite;
-      }
+      counters[counterPosition] = 1;
+      isWhite = !isWhite;
     }
     i++;
   }
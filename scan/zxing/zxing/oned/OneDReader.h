@@ -64,9 +64,10 @@ public:
 
   OneDReader();
   virtual Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints);
+  virtual Ref<Result> tryDecode(Ref<BinaryBitmap> image, DecodeHints hints);
 
-  // Implementations must not throw any exceptions. If a barcode is not found on this row,
-  // a empty ref should be returned e.g. return Ref<Result>();
+  // If a barcode is not found on this row, an empty ref should be returned,
+  // e.g. return Ref<Result>(); a thrown ReaderException is also treated as not found.
   virtual Ref<Result> decodeRow(int rowNumber, Ref<BitArray> row) = 0;
 
   static void recordPattern(Ref<BitArray> row,
@@ -162,8 +162,15 @@ Ref<Result> UPCEANReader::decodeRow(int rowNumber,
 }
 
 UPCEANReader::Range UPCEANReader::findStartGuardPattern(Ref<BitArray> row) {
-  bool foundStart = false;
   Range startRange;
+  if (!tryFindStartGuardPattern(row, startRange)) {
+    throw NotFoundException();
+  }
+  return startRange;
+}
+
+bool UPCEANReader::tryFindStartGuardPattern(Ref<BitArray> row, Range& startRange) {
+  bool foundStart = false;
   int nextStart = 0;
   vector<int> counters(START_END_PATTERN.size(), 0);
   // std::cerr << "fsgp " << *row << std::endl;
@@ -171,7 +178,9 @@ UPCEANReader::Range UPCEANReader::findStartGuardPattern(Ref<BitArray> row) {
     for(int i=0; i < (int)START_END_PATTERN.size(); ++i) {
       counters[i] = 0;
     }
-    startRange = findGuardPattern(row, nextStart, false, START_END_PATTERN, counters);
+    if (!tryFindGuardPattern(row, nextStart, false, START_END_PATTERN, counters, startRange)) {
+      return false;
+    }
     // std::cerr << "sr " << startRange[0] << " " << startRange[1] << std::endl;
     int start = startRange[0];
     nextStart = startRange[1];
@@ -183,7 +192,7 @@ UPCEANReader::Range UPCEANReader::findStartGuardPattern(Ref<BitArray> row) {
       foundStart = row->isRange(quietStart, start, false);
     }
   }
-  return startRange;
+  return true;
 }
 
 UPCEANReader::Range UPCEANReader::findGuardPattern(Ref<BitArray> row,
@@ -199,6 +208,19 @@ UPCEANReader::Range UPCEANReader::findGuardPattern(Ref<BitArray> row,
                                                    bool whiteFirst,
                                                    vector<int> const& pattern,
                                                    vector<int>& counters) {
+  Range range;
+  if (!tryFindGuardPattern(row, rowOffset, whiteFirst, pattern, counters, range)) {
+    throw NotFoundException();
+  }
+  return range;
+}
+
+bool UPCEANReader::tryFindGuardPattern(Ref<BitArray> row,
+                                       int rowOffset,
+                                       bool whiteFirst,
+                                       vector<int> const& pattern,
+                                       vector<int>& counters,
+                                       Range& range) {
   // cerr << "fGP " << rowOffset  << " " << whiteFirst << endl;
   if (false) {
     for(int i=0; i < (int)pattern.size(); ++i) {
@@ -212,30 +234,35 @@ UPCEANReader::Range UPCEANReader::findGuardPattern(Ref<BitArray> row,
   rowOffset = whiteFirst ? row->getNextUnset(rowOffset) : row->getNextSet(rowOffset);
   int counterPosition = 0;
   int patternStart = rowOffset;
-  for (int x = rowOffset; x < width; x++) {
-    // std::cerr << "rg " << x << " " << row->get(x) << std::endl;
-    if (row->get(x) ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if (patternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
-          return Range(patternStart, x);
-        }
-        patternStart += counters[0] + counters[1];
-        for (int y = 2; y < patternLength; y++) {
-          counters[y - 2] = counters[y];
-        }
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
+  int x = rowOffset;
+  while (x < width) {
+    // the rest of the current run in one step
+    int runEnd = isWhite ? row->getNextSet(x) : row->getNextUnset(x);
+    counters[counterPosition] += runEnd - x;
+    x = runEnd;
+    if (x == width) {
+      break;
+    }
+    if (counterPosition == patternLength - 1) {
+      if (patternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
+        range = Range(patternStart, x);
+        return true;
       }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+      patternStart += counters[0] + counters[1];
+      for (int y = 2; y < patternLength; y++) {
+        counters[y - 2] = counters[y];
+      }
+      counters[patternLength - 2] = 0;
+      counters[patternLength - 1] = 0;
+      counterPosition--;
+    } else {
+      counterPosition++;
     }
+    counters[counterPosition] = 1;
+    isWhite = !isWhite;
+    x++;
   }
-  throw NotFoundException();
+  return false;
 }
 
 UPCEANReader::Range UPCEANReader::decodeEnd(Ref<BitArray> row, int endStart) {
@@ -35,6 +35,8 @@ class UPCEANReader : public OneDReader {
   static const int MAX_INDIVIDUAL_VARIANCE;
 
   static Range findStartGuardPattern(Ref<BitArray> row);
+  // As findStartGuardPattern(), but returns false instead of throwing when there is none
+  static bool tryFindStartGuardPattern(Ref<BitArray> row, Range& startRange);
 
   virtual Range decodeEnd(Ref<BitArray> row, int endStart);
 
@@ -45,6 +47,12 @@ class UPCEANReader : public OneDReader {
                                 bool whiteFirst,
                                 std::vector<int> const& pattern,
                                 std::vector<int>& counters);
+  static bool tryFindGuardPattern(Ref<BitArray> row,
+                                  int rowOffset,
+                                  bool whiteFirst,
+                                  std::vector<int> const& pattern,
+                                  std::vector<int>& counters,
+                                  Range& range);
 
 
 protected:
@@ -21,6 +21,7 @@
 
 #include <zxing/qrcode/QRCodeReader.h>
 #include <zxing/qrcode/detector/Detector.h>
+#include <zxing/ReaderException.h>
 
 #include <iostream>
 
@@ -33,15 +34,56 @@ namespace zxing {
         }
         //TODO : see if any of the other files in the qrcode tree need tryHarder
         Ref<Result> QRCodeReader::decode(Ref<BinaryBitmap> image, DecodeHints hints) {
+            Ref<Result> result(tryDecode(image, hints));
+            if (result == 0) {
+                throw ReaderException("No QR code detected");
+            }
+            return result;
+        }
+
+        Ref<Result> QRCodeReader::tryDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
             Detector detector(image->getBlackMatrix());
-            Ref<DetectorResult> detectorResult(detector.detect(hints));
+            Ref<DetectorResult> detectorResult(detector.tryDetect(hints));
+            if (detectorResult == 0) {
+                return Ref<Result>();
+            }
             ArrayRef< Ref<ResultPoint> > points (detectorResult->getPoints());
-            Ref<DecoderResult> decoderResult(decoder_.decode(detectorResult->getBits()));
+            Ref<DecoderResult> decoderResult(tryDecodeFused(detectorResult, hints.getGridFusion()));
+            if (decoderResult == 0) {
+                return Ref<Result>();
+            }
             Ref<Result> result(
                                new Result(decoderResult->getText(), decoderResult->getRawBytes(), points, BarcodeFormat::QR_CODE, decoderResult->charSet()));
             return result;
         }
 
+        // Decodes the grid of this frame, and if it is a symbol that cannot be corrected, the
+        // grid voted from it and the frames before it.
+        Ref<DecoderResult> QRCodeReader::tryDecodeFused(Ref<DetectorResult> detectorResult, Ref<GridFusion> fusion) {
+            if (fusion == 0) {
+                return decoder_.tryDecode(detectorResult->getBits(), detectorResult->getDoubtful());
+            }
+
+            // before decoding, which unmasks the bits in place
+            fusion->add(detectorResult->getBits(), detectorResult->getDoubtful());
+            Ref<DecoderResult> decoderResult;
+            try {
+                decoderResult = decoder_.tryDecode(detectorResult->getBits(), detectorResult->getDoubtful());
+            } catch (ReaderException const&) {
+                // the format information was read, so this is a symbol and its grid gets a vote
+                fusion->vote();
+                if (fusion->getFrameCount() < 2) {
+                    throw;
+                }
+                decoderResult = decoder_.tryDecode(fusion->getBits(), fusion->getDoubtful());
+            }
+            // read: the next symbol starts a new vote
+            if (decoderResult != 0) {
+                fusion->reset();
+            }
+            return decoderResult;
+        }
+
         QRCodeReader::~QRCodeReader() {
         }
 
@@ -24,6 +24,7 @@
 #include <zxing/Reader.h>
 #include <zxing/qrcode/decoder/Decoder.h>
 #include <zxing/DecodeHints.h>
+#include <zxing/common/DetectorResult.h>
 
 namespace zxing {
 namespace qrcode {
@@ -31,6 +32,8 @@ namespace qrcode {
 class QRCodeReader : public Reader {
  private:
   Decoder decoder_;
+
+  Ref<DecoderResult> tryDecodeFused(Ref<DetectorResult> detectorResult, Ref<GridFusion> fusion);
 			
  protected:
   Decoder& getDecoder();
@@ -40,6 +43,7 @@ class QRCodeReader : public Reader {
   virtual ~QRCodeReader();
 			
   Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints);
+  Ref<Result> tryDecode(Ref<BinaryBitmap> image, DecodeHints hints);
 };
 
 }
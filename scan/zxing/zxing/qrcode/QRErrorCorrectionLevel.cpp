@@ -33,7 +33,7 @@ ErrorCorrectionLevel::ErrorCorrectionLevel(int inOrdinal,
 {}
 
 ErrorCorrectionLevel::ErrorCorrectionLevel(const ErrorCorrectionLevel &other) :
-    ordinal_(other.ordinal()), bits_(other.bits()), name_(other.name())
+    Counted(), ordinal_(other.ordinal()), bits_(other.bits()), name_(other.name())
 {}
 
 int ErrorCorrectionLevel::ordinal() const {
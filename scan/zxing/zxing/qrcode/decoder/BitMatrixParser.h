@@ -43,7 +43,12 @@ public:
   BitMatrixParser(Ref<BitMatrix> bitMatrix);
   Ref<FormatInformation> readFormatInformation();
   Version *readVersion();
+  // As above, but an unreadable symbol gives an empty Ref / NULL instead of an exception
+  Ref<FormatInformation> tryReadFormatInformation();
+  Version *tryReadVersion();
   ArrayRef<byte> readCodewords();
+  // As above, also counting for each codeword how many of its modules are set in doubtful
+  ArrayRef<byte> readCodewords(Ref<BitMatrix> doubtful, ArrayRef<byte>& doubtfulBits);
   void remask();
   void setMirror(boolean mirror);
   void mirror();
@@ -37,7 +37,7 @@ private:
   DataBlock(int numDataCodewords, ArrayRef<byte> codewords);
 
 public:
-  static std::vector<Ref<DataBlock> >
+  static ArenaVector<Ref<DataBlock> >
   getDataBlocks(ArrayRef<byte> rawCodewords, Version *version, ErrorCorrectionLevel &ecLevel);
 
   int getNumDataCodewords();
@@ -33,11 +33,18 @@ class Decoder {
 private:
   ReedSolomonDecoder rsDecoder_;
 
-  void correctErrors(ArrayRef<byte> bytes, int numDataCodewords);
+  void correctErrors(ArrayRef<byte> bytes, int numDataCodewords, ArrayRef<byte> doubtfulBits);
+  bool correctWithErasures(ArrayRef<int> codewords, int numECCodewords, ArrayRef<byte> doubtfulBits);
 
 public:
   Decoder();
-  Ref<DecoderResult> decode(Ref<BitMatrix> bits);
+  // doubtful, if given, marks the modules of bits the detector was unsure of (see
+  // DetectorResult::getDoubtful()); a block with more errors than it can correct is then tried
+  // again with the codewords built from those modules as erasures.
+  Ref<DecoderResult> decode(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful = Ref<BitMatrix>());
+  // Returns an empty Ref when the format information or version cannot be read, which is how
+  // most false detections end. A symbol that is read but fails error correction still throws.
+  Ref<DecoderResult> tryDecode(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful = Ref<BitMatrix>());
 };
 
 }
@@ -38,6 +38,14 @@ BitMatrixParser::BitMatrixParser(Ref<BitMatrix> bitMatrix) :
 }
 
 Ref<FormatInformation> BitMatrixParser::readFormatInformation() {
+  Ref<FormatInformation> formatInfo = tryReadFormatInformation();
+  if (formatInfo == 0) {
+    throw ReaderException("Could not decode format information");
+  }
+  return formatInfo;
+}
+
+Ref<FormatInformation> BitMatrixParser::tryReadFormatInformation() {
   if (parsedFormatInfo_ != 0) {
     return parsedFormatInfo_;
   }
@@ -68,13 +76,18 @@ Ref<FormatInformation> BitMatrixParser::readFormatInformation() {
   }
 
   parsedFormatInfo_ = FormatInformation::decodeFormatInformation(formatInfoBits1,formatInfoBits2);
-  if (parsedFormatInfo_ != 0) {
-    return parsedFormatInfo_;
-  }
-  throw ReaderException("Could not decode format information");
+  return parsedFormatInfo_;
 }
 
 Version *BitMatrixParser::readVersion() {
+  Version *version = tryReadVersion();
+  if (version == 0) {
+    throw ReaderException("Could not decode version");
+  }
+  return version;
+}
+
+Version *BitMatrixParser::tryReadVersion() {
   if (parsedVersion_ != 0) {
     return parsedVersion_;
   }
@@ -113,10 +126,16 @@ Version *BitMatrixParser::readVersion() {
   if (parsedVersion_ != 0 && parsedVersion_->getDimensionForVersion() == dimension) {
     return parsedVersion_;
   }
-  throw ReaderException("Could not decode version");
+  parsedVersion_ = 0;
+  return 0;
 }
 
 ArrayRef<byte> BitMatrixParser::readCodewords() {
+  ArrayRef<byte> doubtfulBits;
+  return readCodewords(Ref<BitMatrix>(), doubtfulBits);
+}
+
+ArrayRef<byte> BitMatrixParser::readCodewords(Ref<BitMatrix> doubtful, ArrayRef<byte>& doubtfulBits) {
   Ref<FormatInformation> formatInfo = readFormatInformation();
   Version *version = readVersion();
 
@@ -139,8 +158,12 @@ ArrayRef<byte> BitMatrixParser::readCodewords() {
 
   bool readingUp = true;
   ArrayRef<byte> result(version->getTotalCodewords());
+  if (doubtful) {
+    doubtfulBits = ArrayRef<byte>(version->getTotalCodewords());
+  }
   int resultOffset = 0;
   int currentByte = 0;
+  int currentDoubt = 0;
   int bitsRead = 0;
   // Read columns in pairs, from right to left
   for (int x = dimension - 1; x > 0; x -= 2) {
@@ -161,8 +184,15 @@ ArrayRef<byte> BitMatrixParser::readCodewords() {
           if (bitMatrix_->get(x - col, y)) {
             currentByte |= 1;
           }
+          if (doubtful && doubtful->get(x - col, y)) {
+            currentDoubt++;
+          }
           // If we've made a whole byte, save it off
           if (bitsRead == 8) {
+            if (doubtful) {
+              doubtfulBits[resultOffset] = (byte)currentDoubt;
+              currentDoubt = 0;
+            }
             result[resultOffset++] = (byte)currentByte;
             bitsRead = 0;
             currentByte = 0;
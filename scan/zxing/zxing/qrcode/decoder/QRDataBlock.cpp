@@ -39,7 +39,7 @@ ArrayRef<byte> DataBlock::getCodewords() {
 }
 
 
-std::vector<Ref<DataBlock> > DataBlock::getDataBlocks(ArrayRef<byte> rawCodewords, Version *version,
+ArenaVector<Ref<DataBlock> > DataBlock::getDataBlocks(ArrayRef<byte> rawCodewords, Version *version,
     ErrorCorrectionLevel &ecLevel) {
 
 
@@ -50,13 +50,13 @@ std::vector<Ref<DataBlock> > DataBlock::getDataBlocks(ArrayRef<byte> rawCodeword
 
   // First count the total number of data blocks
   int totalBlocks = 0;
-  vector<ECB*> ecBlockArray = ecBlocks.getECBlocks();
+  vector<ECB*> &ecBlockArray = ecBlocks.getECBlocks();
   for (size_t i = 0; i < ecBlockArray.size(); i++) {
     totalBlocks += ecBlockArray[i]->getCount();
   }
 
   // Now establish DataBlocks of the appropriate size and number of data codewords
-  std::vector<Ref<DataBlock> > result(totalBlocks);
+  ArenaVector<Ref<DataBlock> > result(totalBlocks);
   int numResultBlocks = 0;
   for (size_t j = 0; j < ecBlockArray.size(); j++) {
     ECB *ecBlock = ecBlockArray[j];
@@ -28,6 +28,7 @@
 #include <zxing/ReaderException.h>
 #include <zxing/ChecksumException.h>
 #include <zxing/common/reedsolomon/ReedSolomonException.h>
+#include <algorithm>
 
 using zxing::DecoderResult;
 using zxing::Ref;
@@ -39,11 +40,18 @@ using zxing::BitMatrix;
 namespace zxing {
 namespace qrcode {
 
+namespace {
+  // error correction codewords an erasure decode must leave unused. Trading errors for erasures
+  // spends the redundancy that would otherwise catch a miscorrection; with two codewords to spare
+  // a block of garbage still passes only about once in 65536 tries.
+  const int ERASURE_MARGIN = 2;
+}
+
 Decoder::Decoder() :
   rsDecoder_(GenericGF::QR_CODE_FIELD_256) {
 }
 
-void Decoder::correctErrors(ArrayRef<byte> codewordBytes, int numDataCodewords) {
+void Decoder::correctErrors(ArrayRef<byte> codewordBytes, int numDataCodewords, ArrayRef<byte> doubtfulBits) {
   int numCodewords = codewordBytes->size();
   ArrayRef<int> codewordInts(numCodewords);
   for (int i = 0; i < numCodewords; i++) {
@@ -55,7 +63,9 @@ void Decoder::correctErrors(ArrayRef<byte> codewordBytes, int numDataCodewords)
     rsDecoder_.decode(codewordInts, numECCodewords);
   } catch (ReedSolomonException const& ignored) {
     (void)ignored;
-    throw ChecksumException();
+    if (!doubtfulBits || !correctWithErasures(codewordInts, numECCodewords, doubtfulBits)) {
+      throw ChecksumException();
+    }
   }
 
   for (int i = 0; i < numDataCodewords; i++) {
@@ -63,22 +73,79 @@ void Decoder::correctErrors(ArrayRef<byte> codewordBytes, int numDataCodewords)
   }
 }
 
-Ref<DecoderResult> Decoder::decode(Ref<BitMatrix> bits) {
+// Generalized minimum distance decoding: erase the most doubtful codewords, as many as
+// ERASURE_MARGIN allows, and two fewer each time the decode fails, until one succeeds.
+bool Decoder::correctWithErasures(ArrayRef<int> codewordInts, int numECCodewords, ArrayRef<byte> doubtfulBits) {
+  int numCodewords = codewordInts->size();
+  ArenaVector<int> candidates;
+  for (int i = 0; i < numCodewords; i++) {
+    if (doubtfulBits[i] > 0) {
+      candidates.push_back(i);
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(), [&doubtfulBits](int a, int b) {
+    return doubtfulBits[a] > doubtfulBits[b];
+  });
+
+  int maxErasures = std::min((int)candidates.size(), numECCodewords - ERASURE_MARGIN);
+  ArrayRef<int> attempt(numCodewords);
+  ArenaVector<int> erasures;
+  for (int numErasures = maxErasures; numErasures > 0; numErasures -= 2) {
+    erasures.assign(candidates.begin(), candidates.begin() + numErasures);
+    for (int i = 0; i < numCodewords; i++) {
+      attempt[i] = codewordInts[i];
+    }
+    try {
+      int numErrors = rsDecoder_.decodeWithErasures(attempt, numECCodewords, erasures);
+      if (2 * numErrors + numErasures <= numECCodewords - ERASURE_MARGIN) {
+        for (int i = 0; i < numCodewords; i++) {
+          codewordInts[i] = attempt[i];
+        }
+        return true;
+      }
+    } catch (ReedSolomonException const& ignored) {
+      (void)ignored;
+    }
+  }
+  return false;
+}
+
+Ref<DecoderResult> Decoder::decode(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful) {
+  Ref<DecoderResult> result = tryDecode(bits, doubtful);
+  if (result == 0) {
+    throw ReaderException("Could not decode format information or version");
+  }
+  return result;
+}
+
+Ref<DecoderResult> Decoder::tryDecode(Ref<BitMatrix> bits, Ref<BitMatrix> doubtful) {
   // Construct a parser and read version, error-correction level
   BitMatrixParser parser(bits);
 
   // std::cerr << *bits << std::endl;
 
-  Version *version = parser.readVersion();
-  ErrorCorrectionLevel &ecLevel = parser.readFormatInformation()->getErrorCorrectionLevel();
+  Version *version = parser.tryReadVersion();
+  if (version == 0) {
+    return Ref<DecoderResult>();
+  }
+  Ref<FormatInformation> formatInfo = parser.tryReadFormatInformation();
+  if (formatInfo == 0) {
+    return Ref<DecoderResult>();
+  }
+  ErrorCorrectionLevel &ecLevel = formatInfo->getErrorCorrectionLevel();
 
 
   // Read codewords
-  ArrayRef<byte> codewords(parser.readCodewords());
+  ArrayRef<byte> doubtfulBits;
+  ArrayRef<byte> codewords(parser.readCodewords(doubtful, doubtfulBits));
 
 
-  // Separate into data blocks
-  std::vector<Ref<DataBlock> > dataBlocks(DataBlock::getDataBlocks(codewords, version, ecLevel));
+  // Separate into data blocks, and the doubtful module counts alike
+  ArenaVector<Ref<DataBlock> > dataBlocks(DataBlock::getDataBlocks(codewords, version, ecLevel));
+  ArenaVector<Ref<DataBlock> > doubtfulBlocks;
+  if (doubtfulBits) {
+    doubtfulBlocks = DataBlock::getDataBlocks(doubtfulBits, version, ecLevel);
+  }
 
 
   // Count total number of data bytes
@@ -95,7 +162,8 @@ Ref<DecoderResult> Decoder::decode(Ref<BitMatrix> bits) {
     Ref<DataBlock> dataBlock(dataBlocks[j]);
     ArrayRef<byte> codewordBytes = dataBlock->getCodewords();
     int numDataCodewords = dataBlock->getNumDataCodewords();
-    correctErrors(codewordBytes, numDataCodewords);
+    correctErrors(codewordBytes, numDataCodewords,
+                  doubtfulBlocks.empty() ? ArrayRef<byte>() : doubtfulBlocks[j]->getCodewords());
     for (int i = 0; i < numDataCodewords; i++) {
       resultBytes[resultOffset++] = (byte)codewordBytes[i];
     }
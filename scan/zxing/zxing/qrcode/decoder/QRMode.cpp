@@ -57,7 +57,8 @@ Mode::Mode(int cbv0_9, int cbv10_26, int cbv27, int bits, char const* name) :
 {
 }
 
-Mode::Mode(const zxing::qrcode::Mode &mode)
+Mode::Mode(const zxing::qrcode::Mode &mode) :
+    Counted()
 {
     characterCountBitsForVersions0To9_ = mode.characterCountBitsForVersions0To9_;
     characterCountBitsForVersions10To26_ = mode.characterCountBitsForVersions10To26_;
@@ -36,25 +36,27 @@ private:
   static int MAX_MODULES;
 
   Ref<BitMatrix> image_;
-  std::vector<AlignmentPattern *> *possibleCenters_;
+  ArenaVector<AlignmentPattern *> possibleCenters_;
   int startX_;
   int startY_;
   int width_;
   int height_;
   float moduleSize_;
 
-  static float centerFromEnd(std::vector<int> &stateCount, int end);
-  bool foundPatternCross(std::vector<int> &stateCount);
+  static float centerFromEnd(ArenaVector<int> &stateCount, int end);
+  bool foundPatternCross(ArenaVector<int> &stateCount);
 
   float crossCheckVertical(int startI, int centerJ, int maxCount, int originalStateCountTotal);
 
-  Ref<AlignmentPattern> handlePossibleCenter(std::vector<int> &stateCount, int i, int j);
+  Ref<AlignmentPattern> handlePossibleCenter(ArenaVector<int> &stateCount, int i, int j);
 
 public:
   AlignmentPatternFinder(Ref<BitMatrix> image, int startX, int startY, int width, int height,
                          float moduleSize, Ref<ResultPointCallback>const& callback);
   ~AlignmentPatternFinder();
   Ref<AlignmentPattern> find();
+  // As find(), but returns an empty Ref when there is no alignment pattern
+  Ref<AlignmentPattern> tryFind();
   
 private:
   AlignmentPatternFinder(const AlignmentPatternFinder&);
@@ -47,19 +47,28 @@ protected:
   static Ref<BitMatrix> sampleGrid(Ref<BitMatrix> image, int dimension, Ref<PerspectiveTransform>);
   static int computeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft,
                               float moduleSize);
+  // As computeDimension(), but returns 0 for a dimension no QR code can have
+  static int tryComputeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft,
+                                 float moduleSize);
   float calculateModuleSize(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft);
   float calculateModuleSizeOneWay(Ref<ResultPoint> pattern, Ref<ResultPoint> otherPattern);
   float sizeOfBlackWhiteBlackRunBothWays(int fromX, int fromY, int toX, int toY);
   float sizeOfBlackWhiteBlackRun(int fromX, int fromY, int toX, int toY);
   Ref<AlignmentPattern> findAlignmentInRegion(float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
       float allowanceFactor);
+  Ref<AlignmentPattern> tryFindAlignmentInRegion(float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
+      float allowanceFactor);
   Ref<DetectorResult> processFinderPatternInfo(Ref<FinderPatternInfo> info);
+  Ref<DetectorResult> tryProcessFinderPatternInfo(Ref<FinderPatternInfo> info);
 public:
   virtual Ref<PerspectiveTransform> createTransform(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref <
       ResultPoint > bottomLeft, Ref<ResultPoint> alignmentPattern, int dimension);
 
   Detector(Ref<BitMatrix> image);
   Ref<DetectorResult> detect(DecodeHints const& hints);
+  // Returns an empty Ref instead of throwing when there is no symbol to sample; the try*
+  // variants keep the "nothing here" outcome of a live frame off the exception path.
+  Ref<DetectorResult> tryDetect(DecodeHints const& hints);
 
 
 };
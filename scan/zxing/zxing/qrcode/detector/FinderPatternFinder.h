@@ -43,12 +43,19 @@ protected:
   static int MAX_MODULES;
 
   Ref<BitMatrix> image_;
-  std::vector<Ref<FinderPattern> > possibleCenters_;
+  ArenaVector<Ref<FinderPattern> > possibleCenters_;
   bool hasSkipped_;
 
   Ref<ResultPointCallback> callback_;
   mutable int crossCheckStateCount[5];
 
+  // The lengths of the runs of the row being scanned, from BitMatrix::getRowRuns()
+  ArenaVector<int> scanRuns_;
+  // The image transposed, so that column x is row x and its runs can be found a word at a time
+  // like those of a row. Filled in 64 columns at a time, the first time one of them is checked.
+  Ref<BitMatrix> columns_;
+  ArenaVector<bool> columnStrips_;
+
   /** stateCount must be int[5] */
   static float centerFromEnd(int* stateCount, int end);
   static bool foundPatternCross(int* stateCount);
@@ -64,15 +71,19 @@ protected:
   static std::vector<Ref<FinderPattern> > orderBestPatterns(std::vector<Ref<FinderPattern> > patterns);
 
   Ref<BitMatrix> getImage();
-  std::vector<Ref<FinderPattern> >& getPossibleCenters();
+  ArenaVector<Ref<FinderPattern> >& getPossibleCenters();
 
   bool crossCheckDiagonal(int startI, int centerJ, int maxCount, int originalStateCountTotal) const;
   int *getCrossCheckStateCount() const;
 
+  const BitMatrix& getColumns(int x);
+
 public:
   static float distance(Ref<ResultPoint> p1, Ref<ResultPoint> p2);
   FinderPatternFinder(Ref<BitMatrix> image, Ref<ResultPointCallback>const&);
   Ref<FinderPatternInfo> find(DecodeHints const& hints);
+  // As find(), but returns an empty Ref when fewer than three finder patterns are found
+  Ref<FinderPatternInfo> tryFind(DecodeHints const& hints);
 };
 }
 }
@@ -31,13 +31,14 @@ using zxing::qrcode::AlignmentPattern;
 // VC++
 
 using zxing::BitMatrix;
+using zxing::ArenaVector;
 using zxing::ResultPointCallback;
 
-float AlignmentPatternFinder::centerFromEnd(vector<int>& stateCount, int end) {
+float AlignmentPatternFinder::centerFromEnd(ArenaVector<int>& stateCount, int end) {
   return (float)(end - stateCount[2]) - stateCount[1] / 2.0f;
 }
 
-bool AlignmentPatternFinder::foundPatternCross(vector<int> &stateCount) {
+bool AlignmentPatternFinder::foundPatternCross(ArenaVector<int> &stateCount) {
   float maxVariance = moduleSize_ / 2.0f;
   for (int i = 0; i < 3; i++) {
     if (abs(moduleSize_ - stateCount[i]) >= maxVariance) {
@@ -50,7 +51,7 @@ bool AlignmentPatternFinder::foundPatternCross(vector<int> &stateCount) {
 float AlignmentPatternFinder::crossCheckVertical(int startI, int centerJ, int maxCount,
                                                  int originalStateCountTotal) {
   int maxI = image_->getHeight();
-  vector<int> stateCount(3, 0);
+  ArenaVector<int> stateCount(3, 0);
 
 
   // Start counting up from center
@@ -96,15 +97,15 @@ float AlignmentPatternFinder::crossCheckVertical(int startI, int centerJ, int ma
   return foundPatternCross(stateCount) ? centerFromEnd(stateCount, i) : nan();
 }
 
-Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(vector<int> &stateCount, int i, int j) {
+Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(ArenaVector<int> &stateCount, int i, int j) {
   int stateCountTotal = stateCount[0] + stateCount[1] + stateCount[2];
   float centerJ = centerFromEnd(stateCount, j);
   float centerI = crossCheckVertical(i, (int)centerJ, 2 * stateCount[1], stateCountTotal);
   if (!isnan_z(centerI)) {
     float estimatedModuleSize = (float)(stateCount[0] + stateCount[1] + stateCount[2]) / 3.0f;
-    int max = possibleCenters_->size();
+    int max = possibleCenters_.size();
     for (int index = 0; index < max; index++) {
-      Ref<AlignmentPattern> center((*possibleCenters_)[index]);
+      Ref<AlignmentPattern> center(possibleCenters_[index]);
       // Look for about the same center and module size:
       if (center->aboutEquals(estimatedModuleSize, centerI, centerJ)) {
         return center->combineEstimate(centerI, centerJ, estimatedModuleSize);
@@ -113,7 +114,7 @@ Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(vector<int> &
     AlignmentPattern *tmp = new AlignmentPattern(centerJ, centerI, estimatedModuleSize);
     // Hadn't found this before; save it
     tmp->retain();
-    possibleCenters_->push_back(tmp);
+    possibleCenters_.push_back(tmp);
     if (callback_ != 0) {
       callback_->foundPossibleResultPoint(*tmp);
     }
@@ -125,25 +126,32 @@ Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(vector<int> &
 AlignmentPatternFinder::AlignmentPatternFinder(Ref<BitMatrix> image, int startX, int startY, int width,
                                                int height, float moduleSize, 
                                                Ref<ResultPointCallback>const& callback) :
-    image_(image), possibleCenters_(new vector<AlignmentPattern *> ()), startX_(startX), startY_(startY),
+    image_(image), startX_(startX), startY_(startY),
     width_(width), height_(height), moduleSize_(moduleSize), callback_(callback) {
 }
 
 AlignmentPatternFinder::~AlignmentPatternFinder() {
-  for (int i = 0; i < int(possibleCenters_->size()); i++) {
-    (*possibleCenters_)[i]->release();
-    (*possibleCenters_)[i] = 0;
+  for (int i = 0; i < int(possibleCenters_.size()); i++) {
+    possibleCenters_[i]->release();
+    possibleCenters_[i] = 0;
   }
-  delete possibleCenters_;
 }
 
 Ref<AlignmentPattern> AlignmentPatternFinder::find() {
+  Ref<AlignmentPattern> pattern = tryFind();
+  if (pattern == 0) {
+    throw zxing::ReaderException("Could not find alignment pattern");
+  }
+  return pattern;
+}
+
+Ref<AlignmentPattern> AlignmentPatternFinder::tryFind() {
   int maxJ = startX_ + width_;
   int middleI = startY_ + (height_ >> 1);
   //      Ref<BitArray> luminanceRow(new BitArray(width_));
   // We are looking for black/white/black modules in 1:1:1 ratio;
   // this tracks the number of black/white/black modules seen so far
-  vector<int> stateCount(3, 0);
+  ArenaVector<int> stateCount(3, 0);
   for (int iGen = 0; iGen < height_; iGen++) {
     // Search from middle outwards
     int i = middleI + ((iGen & 0x01) == 0 ? ((iGen + 1) >> 1) : -((iGen + 1) >> 1));
@@ -155,8 +163,9 @@ Ref<AlignmentPattern> AlignmentPatternFinder::find() {
     // Burn off leading white pixels before anything else; if we start in the middle of
     // a white run, it doesn't make sense to count its length, since we don't know if the
     // white run continued to the left of the start point
-    while (j < maxJ && !image_->get(j, i)) {
-      j++;
+    j = image_->getNextSet(j, i);
+    if (j > maxJ) {
+      j = maxJ;
     }
     int currentState = 0;
     while (j < maxJ) {
@@ -199,10 +208,10 @@ Ref<AlignmentPattern> AlignmentPatternFinder::find() {
 
   // Hmm, nothing we saw was observed and confirmed twice. If we had
   // any guess at all, return it.
-  if (possibleCenters_->size() > 0) {
-    Ref<AlignmentPattern> center((*possibleCenters_)[0]);
+  if (possibleCenters_.size() > 0) {
+    Ref<AlignmentPattern> center(possibleCenters_[0]);
     return center;
   }
 
-  throw zxing::ReaderException("Could not find alignment pattern");
+  return Ref<AlignmentPattern>();
 }
@@ -70,16 +70,37 @@ Ref<DetectorResult> Detector::detect(DecodeHints const& hints) {
   return processFinderPatternInfo(info);
 }
 
+Ref<DetectorResult> Detector::tryDetect(DecodeHints const& hints) {
+  callback_ = hints.getResultPointCallback();
+  FinderPatternFinder finder(image_, hints.getResultPointCallback());
+  Ref<FinderPatternInfo> info(finder.tryFind(hints));
+  if (info == 0) {
+    return Ref<DetectorResult>();
+  }
+  return tryProcessFinderPatternInfo(info);
+}
+
 Ref<DetectorResult> Detector::processFinderPatternInfo(Ref<FinderPatternInfo> info){
+  Ref<DetectorResult> result = tryProcessFinderPatternInfo(info);
+  if (result == 0) {
+    throw zxing::ReaderException("Finder patterns do not describe a QR code");
+  }
+  return result;
+}
+
+Ref<DetectorResult> Detector::tryProcessFinderPatternInfo(Ref<FinderPatternInfo> info){
   Ref<FinderPattern> topLeft(info->getTopLeft());
   Ref<FinderPattern> topRight(info->getTopRight());
   Ref<FinderPattern> bottomLeft(info->getBottomLeft());
 
   float moduleSize = calculateModuleSize(topLeft, topRight, bottomLeft);
   if (moduleSize < 1.0f) {
-    throw zxing::ReaderException("bad module size");
+    return Ref<DetectorResult>();
+  }
+  int dimension = tryComputeDimension(topLeft, topRight, bottomLeft, moduleSize);
+  if (dimension == 0) {
+    return Ref<DetectorResult>();
   }
-  int dimension = computeDimension(topLeft, topRight, bottomLeft, moduleSize);
   Version *provisionalVersion = Version::getProvisionalVersionForDimension(dimension);
   int modulesBetweenFPCenters = provisionalVersion->getDimensionForVersion() - 7;
 
@@ -101,14 +122,8 @@ Ref<DetectorResult> Detector::processFinderPatternInfo(Ref<FinderPatternInfo> in
 
 
     // Kind of arbitrary -- expand search radius before giving up
-    for (int i = 4; i <= 16; i <<= 1) {
-      try {
-        alignmentPattern = findAlignmentInRegion(moduleSize, estAlignmentX, estAlignmentY, (float)i);
-        break;
-      } catch (zxing::ReaderException const& re) {
-        (void)re;
-        // try next round
-      }
+    for (int i = 4; i <= 16 && alignmentPattern == 0; i <<= 1) {
+      alignmentPattern = tryFindAlignmentInRegion(moduleSize, estAlignmentX, estAlignmentY, (float)i);
     }
     if (alignmentPattern == 0) {
       // Try anyway
@@ -126,7 +141,8 @@ Ref<DetectorResult> Detector::processFinderPatternInfo(Ref<FinderPatternInfo> in
     points[3].reset(alignmentPattern);
   }
 
-  Ref<DetectorResult> result(new DetectorResult(bits, points));
+  Ref<BitMatrix> doubtful(GridSampler::getInstance().sampleDoubtfulModules(image_, bits, transform));
+  Ref<DetectorResult> result(new DetectorResult(bits, points, doubtful));
   return result;
 }
 
@@ -165,6 +181,17 @@ Ref<BitMatrix> Detector::sampleGrid(Ref<BitMatrix> image, int dimension, Ref<Per
 
 int Detector::computeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft,
                                float moduleSize) {
+  int dimension = tryComputeDimension(topLeft, topRight, bottomLeft, moduleSize);
+  if (dimension == 0) {
+    ostringstream s;
+    s << "Bad dimension for module size " << moduleSize;
+    throw zxing::ReaderException(s.str().c_str());
+  }
+  return dimension;
+}
+
+int Detector::tryComputeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft,
+                                  float moduleSize) {
   int tltrCentersDimension =
     MathUtils::round(ResultPoint::distance(topLeft, topRight) / moduleSize);
   int tlblCentersDimension =
@@ -179,9 +206,7 @@ int Detector::computeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRig
     dimension--;
     break;
   case 3:
-    ostringstream s;
-    s << "Bad dimension: " << dimension;
-    throw zxing::ReaderException(s.str().c_str());
+    return 0;
   }
   return dimension;
 }
@@ -295,21 +320,31 @@ float Detector::sizeOfBlackWhiteBlackRun(int fromX, int fromY, int toX, int toY)
 
 Ref<AlignmentPattern> Detector::findAlignmentInRegion(float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
                                                       float allowanceFactor) {
+  Ref<AlignmentPattern> pattern = tryFindAlignmentInRegion(overallEstModuleSize, estAlignmentX, estAlignmentY, allowanceFactor);
+  if (pattern == 0) {
+    throw zxing::ReaderException("Could not find alignment pattern");
+  }
+  return pattern;
+}
+
+Ref<AlignmentPattern> Detector::tryFindAlignmentInRegion(float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
+                                                         float allowanceFactor) {
   // Look for an alignment pattern (3 modules in size) around where it
   // should be
   int allowance = (int)(allowanceFactor * overallEstModuleSize);
   int alignmentAreaLeftX = max(0, estAlignmentX - allowance);
   int alignmentAreaRightX = min((int)(image_->getWidth() - 1), estAlignmentX + allowance);
   if (alignmentAreaRightX - alignmentAreaLeftX < overallEstModuleSize * 3) {
-    throw zxing::ReaderException("region too small to hold alignment pattern");
+    // region too small to hold alignment pattern
+    return Ref<AlignmentPattern>();
   }
   int alignmentAreaTopY = max(0, estAlignmentY - allowance);
   int alignmentAreaBottomY = min((int)(image_->getHeight() - 1), estAlignmentY + allowance);
   if (alignmentAreaBottomY - alignmentAreaTopY < overallEstModuleSize * 3) {
-    throw zxing::ReaderException("region too small to hold alignment pattern");
+    return Ref<AlignmentPattern>();
   }
 
   AlignmentPatternFinder alignmentFinder(image_, alignmentAreaLeftX, alignmentAreaTopY, alignmentAreaRightX
                                          - alignmentAreaLeftX, alignmentAreaBottomY - alignmentAreaTopY, overallEstModuleSize, callback_);
-  return alignmentFinder.find();
+  return alignmentFinder.tryFind();
 }
@@ -50,10 +50,10 @@ public:
   FurthestFromAverageComparator(float averageModuleSize) :
     averageModuleSize_(averageModuleSize) {
   }
-  int operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
+  bool operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
     float dA = abs(a->getEstimatedModuleSize() - averageModuleSize_);
     float dB = abs(b->getEstimatedModuleSize() - averageModuleSize_);
-    return dA < dB ? -1 : dA == dB ? 0 : 1;
+    return dA < dB;
   }
 };
 
@@ -63,18 +63,78 @@ public:
   CenterComparator(float averageModuleSize) :
     averageModuleSize_(averageModuleSize) {
   }
-  int operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
+  bool operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
     // N.B.: we want the result in descending order ...
     if (a->getCount() != b->getCount()) {
-      return b->getCount() - a->getCount();
+      return a->getCount() > b->getCount();
     } else {
       float dA = abs(a->getEstimatedModuleSize() - averageModuleSize_);
       float dB = abs(b->getEstimatedModuleSize() - averageModuleSize_);
-      return dA < dB ? 1 : dA == dB ? 0 : -1;
+      return dA < dB;
     }
   }
 };
 
+// Transposes 64 rows of 64 bits in place, so that bit j of word i moves to bit i of word j.
+void transposeBlock(BitMatrix::Word* block) {
+  BitMatrix::Word mask = 0x00000000FFFFFFFFULL;
+  for (int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+    for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+      BitMatrix::Word t = ((block[k] >> j) ^ block[k | j]) & mask;
+      block[k] ^= t << j;
+      block[k | j] ^= t;
+    }
+  }
+}
+
+// What crossCheckVertical and crossCheckHorizontal find walking row y of lines pixel by pixel out
+// from start, found a run at a time instead: the five runs around start go into stateCount, end is
+// set past the last of them, and it fails wherever the walk would.
+bool crossCheckRuns(const BitMatrix& lines, int y, int start, int maxCount, int* stateCount, int& end) {
+  int length = lines.getWidth();
+
+  // Back from start: rest of the centre, then white, then black
+  int i = start;
+  if (lines.get(i, y)) {
+    int white = lines.getPreviousUnset(i, y);
+    stateCount[2] += i - white;
+    i = white;
+  }
+  if (i < 0) {
+    return false;
+  }
+  int black = lines.getPreviousSet(i, y);
+  stateCount[1] = i - black;
+  i = black;
+  if (i < 0 || stateCount[1] > maxCount) {
+    return false;
+  }
+  stateCount[0] = i - lines.getPreviousUnset(i, y);
+  if (stateCount[0] > maxCount) {
+    return false;
+  }
+
+  // And on from start
+  i = start + 1;
+  if (i < length && lines.get(i, y)) {
+    int white = lines.getNextUnset(i, y);
+    stateCount[2] += white - i;
+    i = white;
+  }
+  if (i == length) {
+    return false;
+  }
+  black = lines.getNextSet(i, y);
+  stateCount[3] = black - i;
+  i = black;
+  if (i == length || stateCount[3] >= maxCount) {
+    return false;
+  }
+  end = lines.getNextUnset(i, y);
+  stateCount[4] = end - i;
+  return stateCount[4] < maxCount;
+}
+
 }
 
 int FinderPatternFinder::CENTER_QUORUM = 2;
@@ -109,55 +169,9 @@ bool FinderPatternFinder::foundPatternCross(int* stateCount) {
 
 float FinderPatternFinder::crossCheckVertical(size_t startI, size_t centerJ, int maxCount, int originalStateCountTotal) {
 
-  int maxI = image_->getHeight();
   int *stateCount = getCrossCheckStateCount();
-
-  // Start counting up from center
-  int i = startI;
-  while (i >= 0 && image_->get(centerJ, i)) {
-    stateCount[2]++;
-    i--;
-  }
-  if (i < 0) {
-    return nan();
-  }
-  while (i >= 0 && !image_->get(centerJ, i) && stateCount[1] <= maxCount) {
-    stateCount[1]++;
-    i--;
-  }
-  // If already too many modules in this state or ran off the edge:
-  if (i < 0 || stateCount[1] > maxCount) {
-    return nan();
-  }
-  while (i >= 0 && image_->get(centerJ, i) && stateCount[0] <= maxCount) {
-    stateCount[0]++;
-    i--;
-  }
-  if (stateCount[0] > maxCount) {
-    return nan();
-  }
-
-  // Now also count down from center
-  i = startI + 1;
-  while (i < maxI && image_->get(centerJ, i)) {
-    stateCount[2]++;
-    i++;
-  }
-  if (i == maxI) {
-    return nan();
-  }
-  while (i < maxI && !image_->get(centerJ, i) && stateCount[3] < maxCount) {
-    stateCount[3]++;
-    i++;
-  }
-  if (i == maxI || stateCount[3] >= maxCount) {
-    return nan();
-  }
-  while (i < maxI && image_->get(centerJ, i) && stateCount[4] < maxCount) {
-    stateCount[4]++;
-    i++;
-  }
-  if (stateCount[4] >= maxCount) {
+  int end;
+  if (!crossCheckRuns(getColumns(centerJ), centerJ, startI, maxCount, stateCount, end)) {
     return nan();
   }
 
@@ -168,58 +182,15 @@ float FinderPatternFinder::crossCheckVertical(size_t startI, size_t centerJ, int
     return nan();
   }
 
-  return foundPatternCross(stateCount) ? centerFromEnd(stateCount, i) : nan();
+  return foundPatternCross(stateCount) ? centerFromEnd(stateCount, end) : nan();
 }
 
 float FinderPatternFinder::crossCheckHorizontal(size_t startJ, size_t centerI, int maxCount,
     int originalStateCountTotal) {
 
-  int maxJ = image_->getWidth();
   int *stateCount = getCrossCheckStateCount();
-
-  int j = startJ;
-  while (j >= 0 && image_->get(j, centerI)) {
-    stateCount[2]++;
-    j--;
-  }
-  if (j < 0) {
-    return nan();
-  }
-  while (j >= 0 && !image_->get(j, centerI) && stateCount[1] <= maxCount) {
-    stateCount[1]++;
-    j--;
-  }
-  if (j < 0 || stateCount[1] > maxCount) {
-    return nan();
-  }
-  while (j >= 0 && image_->get(j, centerI) && stateCount[0] <= maxCount) {
-    stateCount[0]++;
-    j--;
-  }
-  if (stateCount[0] > maxCount) {
-    return nan();
-  }
-
-  j = startJ + 1;
-  while (j < maxJ && image_->get(j, centerI)) {
-    stateCount[2]++;
-    j++;
-  }
-  if (j == maxJ) {
-    return nan();
-  }
-  while (j < maxJ && !image_->get(j, centerI) && stateCount[3] < maxCount) {
-    stateCount[3]++;
-    j++;
-  }
-  if (j == maxJ || stateCount[3] >= maxCount) {
-    return nan();
-  }
-  while (j < maxJ && image_->get(j, centerI) && stateCount[4] < maxCount) {
-    stateCount[4]++;
-    j++;
-  }
-  if (stateCount[4] >= maxCount) {
+  int end;
+  if (!crossCheckRuns(*image_, centerI, startJ, maxCount, stateCount, end)) {
     return nan();
   }
 
@@ -230,7 +201,7 @@ float FinderPatternFinder::crossCheckHorizontal(size_t startJ, size_t centerI, i
     return nan();
   }
 
-  return foundPatternCross(stateCount) ? centerFromEnd(stateCount, j) : nan();
+  return foundPatternCross(stateCount) ? centerFromEnd(stateCount, end) : nan();
 }
 
 bool FinderPatternFinder::handlePossibleCenter(int* stateCount, size_t i, size_t j) {
@@ -428,6 +399,14 @@ FinderPatternFinder::FinderPatternFinder(Ref<BitMatrix> image,
 }
 
 Ref<FinderPatternInfo> FinderPatternFinder::find(DecodeHints const& hints) {
+  Ref<FinderPatternInfo> info = tryFind(hints);
+  if (info == 0) {
+    throw zxing::ReaderException("Could not find three finder patterns");
+  }
+  return info;
+}
+
+Ref<FinderPatternInfo> FinderPatternFinder::tryFind(DecodeHints const& hints) {
   bool tryHarder = hints.getTryHarder();
 
   size_t maxI = image_->getHeight();
@@ -456,69 +435,76 @@ Ref<FinderPatternInfo> FinderPatternFinder::find(DecodeHints const& hints) {
   BitMatrix& matrix = *image_;
 
   for (size_t i = iSkip - 1; i < maxI && !done; i += iSkip) {
-    // Get a row of black/white values
+    // Get a row of black/white values, as the lengths of its runs starting with white
+    matrix.getRowRuns(i, scanRuns_);
 
     memset(stateCount, 0, sizeof(stateCount));
     int currentState = 0;
-    for (size_t j = 0; j < maxJ; j++) {
-      if (matrix.get(j, i)) {
-        // Black pixel
+    size_t j = 0;
+    for (size_t run = 0; run < scanRuns_.size(); run++) {
+      int length = scanRuns_[run];
+      // the first pixel of the run
+      size_t start = j;
+      j += length;
+      if (length == 0) {
+        continue;
+      }
+      if ((run & 1) == 1) {
+        // Black run
         if ((currentState & 1) == 1) { // Counting white pixels
           currentState++;
         }
-        stateCount[currentState]++;
-      } else { // White pixel
+        stateCount[currentState] += length;
+      } else { // White run
         if ((currentState & 1) == 0) { // Counting black pixels
           if (currentState == 4) { // A winner?
-            if (foundPatternCross(stateCount)) { // Yes
-              bool confirmed = handlePossibleCenter(stateCount, i, j);
-              if (confirmed) {
-                // Start examining every other line. Checking each line turned out to be too
-                // expensive and didn't improve performance.
-                iSkip = 2;
-                if (hasSkipped_) {
-                  done = haveMultiplyConfirmedCenters();
-                } else {
-                  int rowSkip = findRowSkip();
-                  if (rowSkip > stateCount[2]) {
-                    // Skip rows between row of lower confirmed center
-                    // and top of presumed third confirmed center
-                    // but back up a bit to get a full chance of detecting
-                    // it, entire width of center of finder pattern
-
-                    // Skip by rowSkip, but back off by stateCount[2] (size
-                    // of last center of pattern we saw) to be conservative,
-                    // and also back off by iSkip which is about to be
-                    // re-added
-                    i += rowSkip - stateCount[2] - iSkip;
-                    j = maxJ - 1;
-                  }
-                }
+            if (foundPatternCross(stateCount) && handlePossibleCenter(stateCount, i, start)) { // Yes
+              // Start examining every other line. Checking each line turned out to be too
+              // expensive and didn't improve performance.
+              iSkip = 2;
+              bool skipRow = false;
+              if (hasSkipped_) {
+                done = haveMultiplyConfirmedCenters();
               } else {
-                stateCount[0] = stateCount[2];
-                stateCount[1] = stateCount[3];
-                stateCount[2] = stateCount[4];
-                stateCount[3] = 1;
-                stateCount[4] = 0;
-                currentState = 3;
-                continue;
+                int rowSkip = findRowSkip();
+                if (rowSkip > stateCount[2]) {
+                  // Skip rows between row of lower confirmed center
+                  // and top of presumed third confirmed center
+                  // but back up a bit to get a full chance of detecting
+                  // it, entire width of center of finder pattern
+
+                  // Skip by rowSkip, but back off by stateCount[2] (size
+                  // of last center of pattern we saw) to be conservative,
+                  // and also back off by iSkip which is about to be
+                  // re-added
+                  i += rowSkip - stateCount[2] - iSkip;
+                  skipRow = true;
+                }
               }
               // Clear state to start looking again
               currentState = 0;
               memset(stateCount, 0, sizeof(stateCount));
+              if (skipRow) {
+                break;
+              }
+              // The white pixel that ended the pattern is not counted, the rest of the run is
+              if (length > 1) {
+                currentState = 1;
+                stateCount[1] = length - 1;
+              }
             } else { // No, shift counts back by two
               stateCount[0] = stateCount[2];
               stateCount[1] = stateCount[3];
               stateCount[2] = stateCount[4];
-              stateCount[3] = 1;
+              stateCount[3] = length;
               stateCount[4] = 0;
               currentState = 3;
             }
           } else {
-            stateCount[++currentState]++;
+            stateCount[++currentState] += length;
           }
         } else { // Counting white pixels
-          stateCount[currentState]++;
+          stateCount[currentState] += length;
         }
       }
     }
@@ -534,6 +520,11 @@ Ref<FinderPatternInfo> FinderPatternFinder::find(DecodeHints const& hints) {
     }
   }
 
+  if (possibleCenters_.size() < 3) {
+    // Couldn't find enough finder patterns
+    return Ref<FinderPatternInfo>();
+  }
+
   vector< Ref <FinderPattern> > patternInfo = selectBestPatterns();
   vector< Ref <ResultPoint> > patternInfoResPoints;
 
@@ -554,7 +545,7 @@ Ref<BitMatrix> FinderPatternFinder::getImage() {
   return image_;
 }
 
-vector<Ref<FinderPattern> >& FinderPatternFinder::getPossibleCenters() {
+zxing::ArenaVector<Ref<FinderPattern> >& FinderPatternFinder::getPossibleCenters() {
     return possibleCenters_;
 }
 
@@ -643,3 +634,31 @@ int *FinderPatternFinder::getCrossCheckStateCount() const
    memset(crossCheckStateCount, 0, sizeof(crossCheckStateCount));
    return crossCheckStateCount;
 }
+
+const BitMatrix& FinderPatternFinder::getColumns(int x)
+{
+  int width = image_->getWidth();
+  int height = image_->getHeight();
+  if (columns_ == 0) {
+    columns_ = new BitMatrix(height, width);
+    columnStrips_.resize(image_->getRowSize());
+  }
+  int strip = x >> 6;
+  if (!columnStrips_[strip]) {
+    // Transpose the 64 columns around x one 64 by 64 block at a time
+    BitMatrix::Word block[64];
+    int columnCount = std::min(64, width - (strip << 6));
+    for (int top = 0; top < height; top += 64) {
+      int rowCount = std::min(64, height - top);
+      for (int k = 0; k < 64; k++) {
+        block[k] = k < rowCount ? image_->getRowWords(top + k)[strip] : 0;
+      }
+      transposeBlock(block);
+      for (int k = 0; k < columnCount; k++) {
+        columns_->getRowWords((strip << 6) + k)[top >> 6] = block[k];
+      }
+    }
+    columnStrips_[strip] = true;
+  }
+  return *columns_;
+}
@@ -2,21 +2,24 @@
 #include "database/database.h"
 #include "QRHandler.h"
 #include "QRScanner.h"
-
-int main(int argc, char** argv) {
-    testScanner();
-    Database::openDatabase();
-    dbtest::testCreating();
-    dbtest::testLoading();
-
-    return 0;
-
-// testing file for QRHandler & QRScanner
-/*
+#include <QZXing.h>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include "scan/CameraImageWrapper.h"
+#include <zxing/common/Arena.h>
+#include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/HybridBinarizer.h>
+#include <zxing/common/reedsolomon/ReedSolomonDecoder.h>
+#include <zxing/common/reedsolomon/ReedSolomonEncoder.h>
+#include <zxing/qrcode/detector/FinderPatternFinder.h>
+#include <zxing/qrcode/encoder/Encoder.h>
+#include <zxing/qrcode/ErrorCorrectionLevel.h>
+#include <zxing/DecodeHints.h>
+#include <zxing/Exception.h>
+#include <cstdlib>
 #include <iostream>
-
-#include "QRHandler.h"
-#include "QRScanner.h"
+#include <cstring>
 
 void testHandler() {
 	QRHandler myHandle;
@@ -28,19 +31,287 @@ void testScanner() {
 	std::cout << myScanner.decodeFromFile("./img/HelloWorld.png").toUtf8().data();
 }
 
-int main(int argc, char** argv) {
-	testScanner();
-	return 0;
-*/
+// compares a fresh QZXing per decode (the old QRScanner behaviour) with the persistent per-thread decoder
+void benchScanner() {
+	QImage img("./img/HelloWorld.png");
+	const int runs = 200;
+	QElapsedTimer timer;
+
+	timer.start();
+	for (int i = 0; i < runs; i++) {
+		QZXing decoder;
+		decoder.setDecoder( QZXing::DecoderFormat_QR_CODE | QZXing::DecoderFormat_EAN_13 );
+		decoder.decodeImage(img);
+	}
+	qint64 fresh = timer.nsecsElapsed();
+
+	QRScanner myScanner;
+	myScanner.decode(img);
+	timer.restart();
+	for (int i = 0; i < runs; i++) {
+		myScanner.decode(img);
+	}
+	qint64 persistent = timer.nsecsElapsed();
+
+	std::cout << "fresh decoder: " << fresh / runs / 1000 << " us/decode, persistent: " << persistent / runs / 1000 << " us/decode" << std::endl;
 }
 
-void testHandler() {
-	QRHandler myHandle;
-	std::cout << myHandle.generateToFile("Hello World!", "./img/HelloWorld.png");
+// grayscale conversion throughput per camera format at 720p and 1080p. RGBX8888 has no scan line kernel,
+// so it takes the per-pixel QImage::pixel() path every format used before and serves as the baseline;
+// its grey image must match the RGB32 kernel's byte for byte.
+void benchGrayscale() {
+	const QImage::Format formats[] = { QImage::Format_RGB32, QImage::Format_ARGB32, QImage::Format_RGB888, QImage::Format_Grayscale8, QImage::Format_RGBX8888 };
+	const char* names[] = { "RGB32", "ARGB32", "RGB888", "Grayscale8", "RGBX8888 (per pixel)" };
+	const QSize sizes[] = { QSize(1280, 720), QSize(1920, 1080) };
+	const int runs = 50;
+
+	for (int s = 0; s < 2; s++) {
+		QImage rgb(sizes[s], QImage::Format_RGB32);
+		for (int y = 0; y < rgb.height(); y++)
+			for (int x = 0; x < rgb.bytesPerLine(); x++)
+				rgb.scanLine(y)[x] = (uchar)(x * 7 + y * 13);
+
+		for (int f = 0; f < 5; f++) {
+			QImage img = rgb.convertToFormat(formats[f]);
+			QElapsedTimer timer;
+			timer.start();
+			for (int i = 0; i < runs; i++) {
+				Ref<LuminanceSource> source(new CameraImageWrapper(img));
+			}
+			double ms = timer.nsecsElapsed() / 1e6 / runs;
+			std::cout << names[f] << " " << sizes[s].height() << "p: " << ms << " ms/frame, "
+			          << img.width() * img.height() / ms / 1000 << " Mpx/s" << std::endl;
+		}
+
+		ArrayRef<zxing::byte> kernel = CameraImageWrapper(rgb).getMatrix();
+		ArrayRef<zxing::byte> perPixel = CameraImageWrapper(rgb.convertToFormat(QImage::Format_RGBX8888)).getMatrix();
+		bool same = memcmp(&kernel[0], &perPixel[0], kernel->size()) == 0;
+		std::cout << "RGB32 kernel " << (same ? "matches" : "DIFFERS FROM") << " the per-pixel path at " << sizes[s].height() << "p" << std::endl;
+	}
 }
 
-void testScanner() {
-	QRScanner myScanner;
-	std::cout << myScanner.decodeFromFile("./img/HelloWorld.png").toUtf8().data();
+static const int FRAME_WIDTH = 1920;
+static const int FRAME_HEIGHT = 1080;
+static const char* BADGE_TEXT = "3f2a9c1e-5b7d-4e8f-a1b2-c3d4e5f60718";
+
+// A 1080p grey frame: a badge encoding BADGE_TEXT with modules of 'module' pixels on a light background,
+// or no badge when module is 0. Every pixel then gets up to +-noise of random noise.
+static ArrayRef<zxing::byte> greyFrame(int module, int noise) {
+	ArrayRef<zxing::byte> frame(FRAME_WIDTH * FRAME_HEIGHT);
+	for (int i = 0; i < FRAME_WIDTH * FRAME_HEIGHT; i++)
+		frame[i] = 200;
+	if (module > 0) {
+		Ref<qrcode::QRCode> code = qrcode::Encoder::encode(BADGE_TEXT, qrcode::ErrorCorrectionLevel::L);
+		Ref<qrcode::ByteMatrix> modules = code->getMatrix();
+		int size = (int)modules->getWidth();
+		int left = (FRAME_WIDTH - size * module) / 2;
+		int top = (FRAME_HEIGHT - size * module) / 2;
+		for (int y = 0; y < size * module; y++)
+			for (int x = 0; x < size * module; x++)
+				if (modules->get(x / module, y / module))
+					frame[(top + y) * FRAME_WIDTH + left + x] = 30;
+	}
+	srand(1);
+	if (noise > 0) {
+		for (int i = 0; i < FRAME_WIDTH * FRAME_HEIGHT; i++)
+			frame[i] = (zxing::byte)qBound(0, frame[i] + rand() % (2 * noise + 1) - noise, 255);
+	}
+	return frame;
+}
+
+static QImage greyImage(int module, int noise) {
+	ArrayRef<zxing::byte> grey = greyFrame(module, noise);
+	return QImage(&grey[0], FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH, QImage::Format_Grayscale8).copy();
 }
 
+static Ref<LuminanceSource> greySource(ArrayRef<zxing::byte> frame) {
+	return Ref<LuminanceSource>(new GreyscaleLuminanceSource(frame, FRAME_WIDTH, FRAME_HEIGHT, 0, 0, FRAME_WIDTH, FRAME_HEIGHT));
+}
+
+// full frame binarization at 1080p with either binarizer, on a badge filling the middle of the frame and
+// on an empty frame; the global binarizer gives up early when its histogram has no second peak
+void benchBinarizer() {
+	const char* frameNames[] = { "badge", "empty" };
+	ArrayRef<zxing::byte> frames[] = { greyFrame(10, 10), greyFrame(0, 10) };
+	const int runs = 50;
+
+	for (int f = 0; f < 2; f++) {
+		Ref<LuminanceSource> source = greySource(frames[f]);
+		for (int hybrid = 0; hybrid < 2; hybrid++) {
+			int gaveUp = 0;
+			QElapsedTimer timer;
+			timer.start();
+			for (int i = 0; i < runs; i++) {
+				Ref<Binarizer> binarizer(hybrid ? (Binarizer*)new HybridBinarizer(source) : new GlobalHistogramBinarizer(source));
+				try {
+					binarizer->getBlackMatrix();
+				} catch (zxing::Exception&) {
+					gaveUp++;
+				}
+			}
+			std::cout << (hybrid ? "hybrid" : "global") << " binarizer, 1080p " << frameNames[f] << ": "
+			          << timer.nsecsElapsed() / 1e6 / runs << " ms/frame" << (gaveUp ? " (no black point)" : "") << std::endl;
+		}
+	}
+}
+
+// finder pattern search over a whole binarized 1080p frame: a badge, an empty frame and a noise frame,
+// where the row scan finds nothing or many false candidates
+void benchFinder() {
+	const char* frameNames[] = { "badge", "empty", "noise" };
+	ArrayRef<zxing::byte> frames[] = { greyFrame(6, 10), greyFrame(0, 10), greyFrame(0, 100) };
+	const int runs = 50;
+	DecodeHints hints(DecodeHints::QR_CODE_HINT);
+
+	for (int f = 0; f < 3; f++) {
+		Ref<BitMatrix> matrix = HybridBinarizer(greySource(frames[f])).getBlackMatrix();
+		int found = 0;
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < runs; i++) {
+			qrcode::FinderPatternFinder finder(matrix, Ref<ResultPointCallback>());
+			if (finder.tryFind(hints)) found++;
+		}
+		std::cout << "finder search, 1080p " << frameNames[f] << ": " << timer.nsecsElapsed() / 1e6 / runs << " ms/frame, "
+		          << (found ? "found" : "not found") << std::endl;
+	}
+}
+
+// Reed-Solomon decode of one block with no errors, one error and as many as the block corrects (t),
+// in the QR field (a version 10-M block) and the Data Matrix field (a 52x52 block).
+void benchReedSolomon() {
+	const char* fieldNames[] = { "QR", "Data Matrix" };
+	Ref<GenericGF> fields[] = { GenericGF::QR_CODE_FIELD_256, GenericGF::DATA_MATRIX_FIELD_256 };
+	const int dataBytes[] = { 43, 102 };
+	const int ecBytes[] = { 26, 42 };
+	const int runs = 10000;
+
+	for (int f = 0; f < 2; f++) {
+		std::vector<zxing::byte> block(dataBytes[f]);
+		for (int i = 0; i < dataBytes[f]; i++) block[i] = (zxing::byte)(i * 37 + 11);
+		ReedSolomonEncoder(fields[f]).encode(block, ecBytes[f]);
+		const int size = (int)block.size();
+		ReedSolomonDecoder decoder(fields[f]);
+
+		const int errorCounts[] = { 0, 1, ecBytes[f] / 2 };
+		for (int e = 0; e < 3; e++) {
+			ArrayRef<int> received(size);
+			for (int i = 0; i < size; i++) received[i] = block[i];
+			// spread over the block, data and error correction codewords alike
+			for (int i = 0; i < errorCounts[e]; i++) received[i * size / errorCounts[e]] ^= 0x5a;
+
+			ArrayRef<int> codewords(size);
+			bool corrected = true;
+			QElapsedTimer timer;
+			timer.start();
+			for (int r = 0; r < runs; r++) {
+				memcpy(&codewords[0], &received[0], size * sizeof(int));
+				try {
+					decoder.decode(codewords, ecBytes[f]);
+				} catch (const Exception&) {
+					corrected = false;
+				}
+			}
+			qint64 elapsed = timer.nsecsElapsed();
+			for (int i = 0; i < size; i++) {
+				if (codewords[i] != block[i]) corrected = false;
+			}
+			std::cout << "Reed-Solomon, " << fieldNames[f] << " " << size << " codewords, " << errorCounts[e] << " errors: "
+			          << elapsed / 1e3 / runs << " us/block" << (corrected ? "" : ", NOT CORRECTED") << std::endl;
+		}
+	}
+}
+
+// zxing allocations per decode by the persistent decoder, on a 1080p badge and on an empty frame. Heap blocks
+// and arena chunks are malloc calls, arena blocks are not; std containers inside zxing are not counted.
+void benchAllocations() {
+	const char* frameNames[] = { "badge", "empty" };
+	const int modules[] = { 6, 0 };
+	const int runs = 50;
+	QZXing* decoder = QRScanner::decoder();
+
+	for (int f = 0; f < 2; f++) {
+		QImage frame = greyImage(modules[f], 10);
+		// the first decode builds the reader set
+		decoder->decodeImage(frame);
+		Arena::Counts before = Arena::counts();
+		for (int i = 0; i < runs; i++) {
+			decoder->decodeImage(frame);
+		}
+		Arena::Counts after = Arena::counts();
+		std::cout << "allocations per decode, 1080p " << frameNames[f] << ": "
+		          << double(after.heapBlocks - before.heapBlocks) / runs << " heap blocks, "
+		          << double(after.chunks - before.chunks) / runs << " arena chunks, "
+		          << double(after.arenaBlocks - before.arenaBlocks) / runs << " arena blocks" << std::endl;
+	}
+}
+
+// Every frame in turn, rounds times, with a QZXing of this thread's own, as each FramePipeline worker has.
+static QStringList decodeFrames(QList<QImage> frames, int rounds) {
+	QZXing decoder;
+	decoder.setDecoder( QZXing::DecoderFormat_QR_CODE | QZXing::DecoderFormat_EAN_13 );
+	QStringList results;
+	for (int r = 0; r < rounds; r++) {
+		foreach (const QImage& frame, frames) {
+			results << decoder.decodeImage(frame);
+		}
+	}
+	return results;
+}
+
+// Decodes the same frames on several threads at once and checks every result against a decode of the
+// frame on this thread alone. Built with ThreadSanitizer it is also a race check of the state zxing
+// shares between decoders (reference counts, GF tables, reader sets):
+//   qmake CONFIG+=bench QMAKE_CXXFLAGS+=-fsanitize=thread QMAKE_LFLAGS+=-fsanitize=thread
+//   boo-bench stress
+bool stressDecoders() {
+	const int threads = 8;
+	const int rounds = 10;
+	const int modules[] = { 4, 6, 8, 0 };
+	QList<QImage> frames;
+	for (int i = 0; i < 4; i++) {
+		frames << greyImage(modules[i], 10);
+	}
+	QStringList expected = decodeFrames(frames, 1);
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	QList<QFuture<QStringList> > futures;
+	for (int t = 0; t < threads; t++) {
+		futures << QtConcurrent::run(&pool, decodeFrames, frames, rounds);
+	}
+	int decodes = 0;
+	int mismatches = 0;
+	foreach (const QFuture<QStringList>& future, futures) {
+		QStringList results = future.result();
+		for (int i = 0; i < results.size(); i++, decodes++) {
+			if (results[i] != expected[i % frames.size()]) mismatches++;
+		}
+	}
+	std::cout << threads << " threads, " << decodes << " decodes: " << mismatches
+	          << " differ from the sequential decode" << std::endl;
+	return mismatches == 0;
+}
+
+// qmake CONFIG+=bench builds this file instead of main.cpp; "boo-bench bench" runs the benchmarks,
+// "boo-bench stress" the parallel decode check
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "stress") == 0) {
+        return stressDecoders() ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        benchScanner();
+        benchGrayscale();
+        benchBinarizer();
+        benchFinder();
+        benchReedSolomon();
+        benchAllocations();
+        return 0;
+    }
+    testScanner();
+    Database::openDatabase();
+    dbtest::testCreating();
+    dbtest::testLoading();
+
+    return 0;
+}